@@ -0,0 +1,302 @@
+#include "periscope.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace periscope;
+
+// Microbenchmarks of the core graph/object API, the parallel render uses one worker per hardware thread
+// Usage: periscope_bench [--format=csv|json] [--max-elements=N] [--repeat=N]
+
+// bench_result is the best of the repeated runs of a case
+struct bench_result
+{
+    std::string Case;
+    std::string HandleType;
+    std::size_t Elements;
+    std::uint64_t TotalNs;
+};
+
+// bench_options is the command line configuration
+struct bench_options
+{
+    bool Json = false;
+    std::size_t MaxElements = 1000000;
+    int Repeat = 3;
+};
+
+// sink keeps measured results observable so the work is not optimized away
+static volatile std::size_t sink;
+
+// handle_type_name is the name reported for the handle type
+template<typename underlying_type>
+constexpr std::string_view
+handle_type_name()
+{
+    if constexpr (std::is_same_v<underlying_type, int>)
+        return "int";
+    else if constexpr (std::is_same_v<underlying_type, std::string>)
+        return "std::string";
+    else
+        return "const void*";
+}
+
+// handle_of is the typed handle of an object
+template<typename underlying_type>
+handle<underlying_type>
+handle_of(const base_object& _object)
+{
+    return *std::static_pointer_cast<handle<underlying_type>>(_object.get_handle());
+}
+
+// measure is the best time of the timed step, setup runs untimed before every repetition
+std::uint64_t
+measure(int _repeat, const std::function<void()>& _setup, const std::function<void()>& _timed)
+{
+    std::uint64_t best = std::numeric_limits<std::uint64_t>::max();
+    for (int i = 0; i < _repeat; ++i) {
+        _setup();
+        auto start = std::chrono::steady_clock::now();
+        _timed();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min<std::uint64_t>(
+          best, std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+    }
+    return best;
+}
+
+// fixture is a graph of named nodes with a link between each consecutive pair
+template<typename underlying_type>
+struct fixture
+{
+    std::unique_ptr<graph<underlying_type>> Graph;
+    std::vector<node*> Nodes;
+    std::vector<handle<underlying_type>> Handles;
+
+    // build is to rebuild the graph with _elements objects, nodes and links when _with_links is set
+    void build(std::size_t _elements, bool _with_links)
+    {
+        Graph = std::make_unique<graph<underlying_type>>();
+        Nodes.clear();
+        Handles.clear();
+        std::size_t node_count = _with_links ? (_elements + 1) / 2 : _elements;
+        for (std::size_t i = 0; i < node_count; ++i) {
+            node& n = Graph->template new_object<node>();
+            n.set<OP_name>("node" + std::to_string(i));
+            Nodes.push_back(&n);
+            Handles.push_back(handle_of<underlying_type>(n));
+        }
+        if (!_with_links)
+            return;
+        for (std::size_t i = 0; i + node_count < _elements; ++i) {
+            Graph->template new_object<periscope::link>()
+              .template set<LP_source>(*Nodes[i % node_count])
+              .template set<LP_target>(*Nodes[(i + 1) % node_count]);
+        }
+    }
+};
+
+// run_cases is to benchmark every case for one handle type
+template<typename underlying_type>
+void
+run_cases(const bench_options& _options, std::size_t _elements, std::vector<bench_result>& _results)
+{
+    const std::string handle_type(handle_type_name<underlying_type>());
+    fixture<underlying_type> data;
+    auto record = [&](const char* _case, std::uint64_t _ns) {
+        _results.push_back(bench_result{ _case, handle_type, _elements, _ns });
+    };
+
+    record("new_object<node>",
+           measure(
+             _options.Repeat,
+             [&] { data.Graph = std::make_unique<graph<underlying_type>>(); },
+             [&] {
+                 for (std::size_t i = 0; i < _elements; ++i)
+                     data.Graph->template new_object<node>();
+             }));
+
+    record("new_object<link>",
+           measure(
+             _options.Repeat,
+             [&] { data.Graph = std::make_unique<graph<underlying_type>>(); },
+             [&] {
+                 for (std::size_t i = 0; i < _elements; ++i)
+                     data.Graph->template new_object<periscope::link>();
+             }));
+
+    record("new_links",
+           measure(
+             _options.Repeat,
+             [&] { data.build(_elements, false); },
+             [&] {
+                 const std::size_t count = data.Nodes.size();
+                 data.Graph->new_links(
+                   std::views::iota(std::size_t{ 0 }, _elements),
+                   [&](std::size_t _i) -> const node& { return *data.Nodes[_i % count]; },
+                   [&](std::size_t _i) -> const node& { return *data.Nodes[(_i + 1) % count]; });
+             }));
+
+    record("set<OP_name>",
+           measure(
+             _options.Repeat,
+             [&] { data.build(_elements, false); },
+             [&] {
+                 for (node* n : data.Nodes)
+                     n->set<OP_name>("renamed");
+             }));
+
+    record("get<OP_name>",
+           measure(
+             _options.Repeat,
+             [&] { data.build(_elements, false); },
+             [&] {
+                 std::size_t total = 0;
+                 for (node* n : data.Nodes)
+                     total += n->get<OP_name>().Value.size();
+                 sink = total;
+             }));
+
+    record("access<node>",
+           measure(
+             _options.Repeat,
+             [&] { data.build(_elements, false); },
+             [&] {
+                 std::size_t total = 0;
+                 for (auto& h : data.Handles)
+                     total += reinterpret_cast<std::uintptr_t>(&data.Graph->template access<node>(h));
+                 sink = total;
+             }));
+
+    record("visit",
+           measure(
+             _options.Repeat,
+             [&] { data.build(_elements, true); },
+             [&] {
+                 std::size_t total = 0;
+                 data.Graph->template visit<node, periscope::link>(
+                   [&total](const auto& _object) { total += _object.template has<OP_name>(); });
+                 sink = total;
+             }));
+
+    record("delete_object",
+           measure(
+             _options.Repeat,
+             [&] { data.build(_elements, false); },
+             [&] {
+                 for (auto& h : data.Handles)
+                     data.Graph->delete_object(h);
+             }));
+
+    record("to_string",
+           measure(
+             _options.Repeat,
+             [&] { data.build(_elements, true); },
+             [&] { sink = data.Graph->to_string().size(); }));
+
+    std::string snapshot;
+    record("save_snapshot",
+           measure(
+             _options.Repeat,
+             [&] {
+                 data.build(_elements, true);
+                 snapshot.clear();
+             },
+             [&] { sink = data.Graph->save_snapshot(snapshot).size(); }));
+
+    record("load_snapshot",
+           measure(
+             _options.Repeat,
+             [&] {
+                 data.build(_elements, true);
+                 snapshot.clear();
+                 data.Graph->save_snapshot(snapshot);
+             },
+             [&] { sink = graph<underlying_type>::load_snapshot(snapshot_view(snapshot)).contains(data.Handles[0]); }));
+
+    worker_pool pool;
+    record("to_string(worker_pool)",
+           measure(
+             _options.Repeat,
+             [&] { data.build(_elements, true); },
+             [&] { sink = data.Graph->to_string(pool).size(); }));
+}
+
+// print_csv is to write the results as CSV
+void
+print_csv(const std::vector<bench_result>& _results)
+{
+    std::cout << "case,handle_type,elements,total_ns,ns_per_element\n";
+    for (auto& result : _results) {
+        std::cout << result.Case << ',' << result.HandleType << ',' << result.Elements << ',' << result.TotalNs << ','
+                  << static_cast<double>(result.TotalNs) / result.Elements << '\n';
+    }
+}
+
+// print_json is to write the results as JSON array
+void
+print_json(const std::vector<bench_result>& _results)
+{
+    std::cout << "[\n";
+    for (std::size_t i = 0; i < _results.size(); ++i) {
+        auto& result = _results[i];
+        std::cout << "  {\"case\": \"" << result.Case << "\", \"handle_type\": \"" << result.HandleType
+                  << "\", \"elements\": " << result.Elements << ", \"total_ns\": " << result.TotalNs
+                  << ", \"ns_per_element\": " << static_cast<double>(result.TotalNs) / result.Elements << '}'
+                  << (i + 1 < _results.size() ? ",\n" : "\n");
+    }
+    std::cout << "]\n";
+}
+
+// parse_options is to read the command line
+bool
+parse_options(int _argc, char** _argv, bench_options& _options)
+{
+    for (int i = 1; i < _argc; ++i) {
+        std::string_view arg(_argv[i]);
+        if (arg == "--format=csv") {
+            _options.Json = false;
+        } else if (arg == "--format=json") {
+            _options.Json = true;
+        } else if (arg.starts_with("--max-elements=")) {
+            _options.MaxElements = std::strtoull(_argv[i] + arg.find('=') + 1, nullptr, 10);
+        } else if (arg.starts_with("--repeat=")) {
+            _options.Repeat = std::max(1, std::atoi(_argv[i] + arg.find('=') + 1));
+        } else {
+            std::cerr << "Usage: " << _argv[0] << " [--format=csv|json] [--max-elements=N] [--repeat=N]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int
+main(int argc, char** argv)
+{
+    bench_options options;
+    if (!parse_options(argc, argv, options))
+        return 1;
+
+    std::vector<bench_result> results;
+    for (std::size_t elements : { std::size_t{ 1000 }, std::size_t{ 100000 }, std::size_t{ 1000000 } }) {
+        if (elements > options.MaxElements)
+            break;
+        run_cases<int>(options, elements, results);
+        run_cases<std::string>(options, elements, results);
+        run_cases<const void*>(options, elements, results);
+    }
+
+    if (options.Json)
+        print_json(results);
+    else
+        print_csv(results);
+    return 0;
+}
\ No newline at end of file
@@ -2,127 +2,360 @@
 
 #include "graph/periscope_graph_fwd.h"
 #include "graph/periscope_graph_properties.h"
+#include "graph/periscope_snapshot.h"
 #include "link/periscope_link.h"
 #include "misc/periscope_class_def.h"
 #include "misc/periscope_note.h"
 #include "node/periscope_node.h"
 #include "object/periscope_handle.h"
+#include "object/periscope_handle_index.h"
 #include "object/periscope_object.h"
 #include "object/periscope_object_properties.h"
 #include "tools/periscope_guard.h"
+#include "tools/periscope_object_pool.h"
+#include "tools/periscope_string_pool.h"
+#include "tools/periscope_worker_pool.h"
 #include "type_hash/periscope_type_hash.h"
+#include "type_hash/periscope_type_index.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
 #include <format>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <ostream>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace periscope {
 // ------------------------ Main template -----------------------
 
+// property_types is the registry of the properties of the object types graphs store, in the order of their property
+// sets, registering them checks that their static hashes don't collide
+using property_types = type_registry<type_list_concat_t<property_set_t<base_object>,
+                                                        property_set_t<class_def>,
+                                                        property_set_t<node>,
+                                                        property_set_t<link>,
+                                                        property_set_t<note>>>;
+static_assert(object_types::distinct && property_types::distinct, "static_hash collision between registered types");
+
 // graph is container for nodes and links with graph type management
 template<typename underlying_type>
 class graph : public object<graph<underlying_type>>
 {
+    static_assert(type_registry<type_list_concat_t<property_types::list_type, property_set_t<graph>>>::distinct,
+                  "static_hash collision between graph properties");
+
+    // no_label is the label projection of unnamed links
+    struct no_label
+    {
+        template<typename element>
+        std::string_view operator()(const element&) const
+        {
+            return {};
+        }
+    };
+
   public:
     graph()
     {
         // default type is flowchart
         this->template set<GP_type>(graph_type::k_flowchart);
         this->template set<OP_printable>(true);
+        this->m_string_pool = m_strings.get();
     }
 
+    // objects are returned to the pools of the graph, so the pools must outlive them
+    graph(graph&&) = default;
+    graph& operator=(graph&&) = delete;
+
     // to_string is to convert graph to string representation
     std::string to_string() const
     {
-        if (!this->template has<GP_type<underlying_type>>())
-            throw std::runtime_error("Graph type not set, please set it before calling to_string");
-        io().GraphType = this->template get<GP_type<underlying_type>>().Value;
-        return object<graph<underlying_type>>::to_string();
+        std::string str;
+        render_to(str);
+        return str;
     }
 
-    // Bring base class set into scope for non-template properties
-    using object<graph<underlying_type>>::set;
+    // render_to is to write graph string representation to output stream
+    std::ostream& render_to(std::ostream& _stream) const
+    {
+        render_to(std::ostreambuf_iterator<char>(_stream));
+        return _stream;
+    }
 
-    // set is to set property value with type checking
-    template<template<typename> class prop>
-    graph& set(const typename prop<underlying_type>::type& _value)
+    // render_to is to append graph string representation to string buffer
+    std::string& render_to(std::string& _buffer) const
     {
-        static_assert(std::is_base_of_v<typename prop<underlying_type>::owner_type, graph<underlying_type>>,
-                      "Owner must be a derived class of prop::owner_type");
-        this->template get_or_create<prop<underlying_type>>().Value = _value;
-        return *this;
+        render_to(string_appender(_buffer));
+        return _buffer;
     }
 
-  public:
-    // to_string_impl is implementation of object::to_string_impl
-    std::string to_string_impl(graph_type _graph_type = io().GraphType) const
+    // render_to is to write graph string representation to output iterator
+    template<typename output_iterator>
+        requires std::output_iterator<output_iterator, char>
+    output_iterator render_to(output_iterator _out) const
     {
-        std::string str = "";
+        return object<graph<underlying_type>>::render_to(_out, make_context());
+    }
 
-        graph_output_format output_format = graph_output_format::k_markdown;
-        if (this->template has<GP_output_format<underlying_type>>())
-            output_format = this->template get<GP_output_format<underlying_type>>().Value;
+    // render_to is to append graph string representation to string buffer, rendering chunks of each phase on the
+    // workers of the pool, the output is identical to the serial render
+    std::string& render_to(std::string& _buffer, worker_pool& _pool) const
+    {
+        const render_context context = make_context();
+        if (!this->template has<OP_printable>())
+            return _buffer;
+        auto fragments = lock_fragments(context);
 
-        switch (output_format) {
-            case graph_output_format::k_markdown:
-                str += "```mermaid\n";
-                break;
-            default:
-                break;
+        // slices of all phases are rendered in one batch into their own buffers, then appended in phase order
+        struct slice
+        {
+            render_phase Phase;
+            std::size_t Begin;
+            std::size_t End;
+            std::string Text;
+        };
+        std::vector<slice> slices;
+        const std::size_t target_slices = _pool.concurrency() * k_slices_per_worker;
+        for (render_phase phase : { k_render_class_defs, k_render_nodes, k_render_messages, k_render_classes }) {
+            const std::size_t size = m_buckets[bucket_of(phase)].Elements.size();
+            const std::size_t step = std::max(k_min_slice_size, (size + target_slices - 1) / target_slices);
+            for (std::size_t begin = 0; begin < size; begin += step)
+                slices.push_back(slice{ phase, begin, std::min(size, begin + step), {} });
         }
-
-        guard _guard([&str, output_format]() {
-            switch (output_format) {
-                case graph_output_format::k_markdown:
-                    str += "```\n";
-                    break;
-                default:
-                    break;
-            }
+        _pool.run(slices.size(), [this, &slices, &context](std::size_t _index) {
+            slice& slice = slices[_index];
+            render_phase_to(string_appender(slice.Text), slice.Phase, slice.Begin, slice.End, context);
         });
 
-        // Title
-        if (this->template has<OP_name>()) {
-            str += std::format("---\ntitle: {}\n---\n", this->template _V_str<OP_name>());
+        std::size_t total = 0;
+        for (auto& slice : slices)
+            total += slice.Text.size();
+        _buffer.reserve(_buffer.size() + total + 256);
+        auto out = render_prologue(string_appender(_buffer), context);
+        for (auto& slice : slices)
+            _buffer.append(slice.Text);
+        render_epilogue(out, context);
+        return _buffer;
+    }
+
+    // render_since is to write what was added since the cursor and advance it, the first call writes the header,
+    // later calls only the participants, messages and notes created since, only sequence graphs are supported
+    template<typename output_iterator>
+        requires std::output_iterator<output_iterator, char>
+    output_iterator render_since(output_iterator _out, render_cursor& _cursor) const
+    {
+        render_context context = make_context();
+        if (context.GraphType != graph_type::k_sequence)
+            throw std::runtime_error("render_since is only supported for sequence graphs");
+        if (!this->template has<OP_printable>())
+            return _out;
+
+        // a delta can't close a markdown fence, so the lines are plain mermaid
+        context.OutputFormat = graph_output_format::k_mermaid;
+        auto fragments = lock_fragments(context);
+        if (!_cursor.HeaderWritten) {
+            _out = render_prologue(_out, context);
+            _cursor.HeaderWritten = true;
+        }
+        for (render_phase phase : { k_render_nodes, k_render_messages }) {
+            const auto& bucket = m_buckets[bucket_of(phase)];
+            auto first = std::upper_bound(bucket.Sequences.begin(), bucket.Sequences.end(), _cursor.Sequence);
+            _out = render_phase_to(
+              _out, phase, static_cast<std::size_t>(first - bucket.Sequences.begin()), bucket.Elements.size(), context);
         }
+        _cursor.Sequence = m_sequence;
+        return _out;
+    }
 
-        // Graph info
-        str += this->template _V_str<GP_type<underlying_type>>();
-        str += " ";
-        str += this->template _V_str<GP_flowchart_direction<underlying_type>>();
-        str += "\n";
+    // render_since is to render what was added since the cursor to string and advance it
+    std::string render_since(render_cursor& _cursor) const
+    {
+        std::string str;
+        render_since(std::back_inserter(str), _cursor);
+        return str;
+    }
 
-        // Configuration info
-        str += this->template _V_str<GP_sequence_show_number<underlying_type>>();
-        str += "\n";
+    // to_string is to convert graph to string representation, rendering on the workers of the pool
+    std::string to_string(worker_pool& _pool) const
+    {
+        std::string str;
+        render_to(str, _pool);
+        return str;
+    }
+
+    // save_snapshot is to append the binary snapshot of the graph to the buffer, objects keep their render order and
+    // handles, properties that can't be saved such as GP_sampler are left out
+    std::string& save_snapshot(std::string& _buffer) const
+    {
+        snapshot_writer<underlying_type> writer(*m_handle_table);
+        for (auto& bucket : m_buckets) {
+            for (auto& ptr : bucket.Elements) {
+                if (ptr)
+                    writer.add(*ptr);
+            }
+        }
+        writer.write(*this, _buffer);
+        return _buffer;
+    }
+
+    // save_snapshot is to write the binary snapshot of the graph to output stream
+    std::ostream& save_snapshot(std::ostream& _stream) const
+    {
+        std::string buffer;
+        save_snapshot(buffer);
+        return _stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
 
-        // Forward declare class definitions
-        traverser<class_def>::traverse(
-          *this, [&str](class_def& class_def) { str += std::format("{}\n", class_def.to_string()); });
+    // load_snapshot is to rebuild a graph from its snapshot, it renders the same as the graph it was saved from
+    static graph load_snapshot(const snapshot_view& _snapshot)
+    {
+        graph loaded;
+        std::vector<base_object*> objects;
+        std::vector<handle_ref> refs;
+        objects.reserve(_snapshot.object_count());
+        refs.reserve(_snapshot.object_count() + _snapshot.retired_count());
+        for (std::size_t i = 0; i < _snapshot.object_count(); ++i) {
+            objects.push_back(&loaded.restore_object(_snapshot.object(i)));
+            refs.push_back(objects.back()->get_handle_ref());
+        }
+        for (std::size_t i = 0; i < _snapshot.retired_count(); ++i)
+            refs.push_back(loaded.retired_ref(_snapshot.retired(i).template handle_id<underlying_type>()));
+        for (std::size_t i = 0; i < _snapshot.object_count(); ++i)
+            restore_properties(_snapshot.object(i), *objects[i], refs);
 
-        // Draw nodes
-        traverser<node>::traverse(*this, [&str](node& node) { str += std::format("{}\n", node.to_string()); });
+        // graph properties come last, so a message capacity doesn't evict objects while they are restored
+        restore_snapshot_properties<base_object>(_snapshot.graph_properties(), loaded, {});
+        restore_snapshot_properties<graph>(_snapshot.graph_properties(), loaded, {});
+        loaded.restore_link_keys();
+        return loaded;
+    }
 
-        // Draw links and notes
-        traverser<type_list<link, note>>::traverse(
-          *this, [&str](base_object& object) { str += std::format("{}\n", object.to_string()); });
+    // merge is to copy the objects of _other after the objects of this graph, handle ids free here are kept and
+    // colliding ones are treated by the policy, references between the copied objects are rewritten to match, costs
+    // linear time in the size of _other so merge the smaller graph into the larger one
+    graph& merge(const graph& _other, merge_policy _policy = merge_policy::k_remap)
+    {
+        std::vector<incoming_object> incoming;
+        incoming.reserve(_other.object_count());
+        for (std::size_t kind = 0; kind < k_element_kind_count; ++kind) {
+            for (const auto& ptr : _other.m_buckets[kind].Elements) {
+                if (ptr) {
+                    incoming.push_back(incoming_object{
+                      copy_object(*ptr), id_of(*ptr), ptr->get_handle_ref(), element_kind(kind) });
+                }
+            }
+        }
+        adopt(incoming, *_other.m_handle_table, _policy);
+        return *this;
+    }
 
-        // Assign node names to class definitions
-        traverser<node>::traverse(*this, [&str](node& node) {
-            if (node.has<NP_class_def>()) {
-                str +=
-                  std::format("class {} {}Class\n", node.get_handle()->print(), node.template _V_str<NP_class_def>());
+    // merge is to move the objects of _other after the objects of this graph like the copying merge, without copying
+    // them, _other is left empty
+    graph& merge(graph&& _other, merge_policy _policy = merge_policy::k_remap)
+    {
+        if (&_other == this)
+            return *this;
+        std::vector<incoming_object> incoming;
+        incoming.reserve(_other.object_count());
+        for (std::size_t kind = 0; kind < k_element_kind_count; ++kind) {
+            auto& bucket = _other.m_buckets[kind];
+            for (auto& ptr : bucket.Elements) {
+                if (!ptr)
+                    continue;
+                const underlying_type id = id_of(*ptr);
+                const handle_ref ref = ptr->get_handle_ref();
+                _other.m_handle_table->unbind(*ptr->get_handle());
+                _other.m_index.erase(id);
+                _other.m_handle_manager.deallocate(handle<underlying_type>(id));
+                incoming.push_back(incoming_object{ std::move(ptr), id, ref, element_kind(kind) });
             }
-        });
-        return str;
+            bucket = element_bucket{};
+        }
+
+        // the moved objects return to the pools they were created from, which now belong to this graph
+        for (auto& pool : _other.m_pools)
+            m_pools.push_back(std::move(pool));
+        _other.m_pools.clear();
+        _other.m_typed_pools.fill(nullptr);
+        _other.m_message_refs.clear();
+        _other.m_orphans.clear();
+        _other.m_new_participants.clear();
+        _other.m_link_keys.clear();
+        adopt(incoming, *_other.m_handle_table, _policy);
+        return *this;
+    }
+
+    // Bring base class set into scope for non-template properties
+    using object<graph<underlying_type>>::set;
+
+    // set is to set property value with type checking
+    template<template<typename> class prop>
+    graph& set(const typename prop<underlying_type>::type& _value)
+    {
+        static_assert(std::is_base_of_v<typename prop<underlying_type>::owner_type, graph<underlying_type>>,
+                      "Owner must be a derived class of prop::owner_type");
+        this->template get_or_create<prop<underlying_type>>().Value = _value;
+        return *this;
+    }
+
+  public:
+    // render_to_impl is implementation of object::render_to_impl
+    template<typename output_iterator>
+    output_iterator render_to_impl(output_iterator _out, const render_context& _context = {}) const
+    {
+        auto fragments = lock_fragments(_context);
+        _out = render_prologue(_out, _context);
+        for (render_phase phase : { k_render_class_defs, k_render_nodes, k_render_messages, k_render_classes })
+            _out = render_phase_to(_out, phase, 0, m_buckets[bucket_of(phase)].Elements.size(), _context);
+        return render_epilogue(_out, _context);
+    }
+
+    // visit is to call _callback with every object of the types ts, all registered object types if none are given,
+    // cast to the type it was created as, in render order, the type is picked by comparing dense type indices inline
+    // so the callback is inlined too, objects must not be created or deleted until it returns
+    template<typename... ts, typename callback>
+    void visit(callback&& _callback)
+    {
+        visit_objects(*this, visited_types<ts...>{}, _callback);
+    }
+
+    // visit is to call _callback with every const object of the types ts like the mutable visit
+    template<typename... ts, typename callback>
+    void visit(callback&& _callback) const
+    {
+        visit_objects(*this, visited_types<ts...>{}, _callback);
+    }
+
+    // render_object_to is to write the text of an object of this graph, registered object types are rendered
+    // without virtual dispatch
+    template<typename output_iterator>
+        requires std::output_iterator<output_iterator, char>
+    output_iterator render_object_to(output_iterator _out, const base_object& _object) const
+    {
+        const render_context context = make_context();
+        if (_object.type_index() == object_types::size)
+            return std::ranges::copy(_object.to_string(context), _out).out;
+        auto fragments = lock_fragments(context);
+        return render_element<class_def, node, link, note>(_out, _object, context);
     }
 
     template<typename t>
     struct traverser
     {
-        static void traverse(const graph<underlying_type>& _graph, const std::function<void(t&)>& _callback)
+        template<typename callback>
+        static void traverse(const graph<underlying_type>& _graph, const callback& _callback)
         {
-            for (auto& ptr : _graph.m_elements) {
-                if (ptr->template get<OP_type>().Value == static_hash<t>()) {
+            for (auto& ptr : _graph.m_buckets[kind_of<t>()].Elements) {
+                if (ptr && is_a<t>(*ptr)) {
                     _callback(*static_cast<t*>(ptr.get()));
                 }
             }
@@ -132,10 +365,13 @@ class graph : public object<graph<underlying_type>>
     template<typename... ts>
     struct traverser<type_list<ts...>>
     {
-        static void traverse(const graph<underlying_type>& _graph, const std::function<void(base_object&)>& _callback)
+        template<typename callback>
+        static void traverse(const graph<underlying_type>& _graph, const callback& _callback)
         {
-            for (auto& ptr : _graph.m_elements) {
-                if (((ptr->template get<OP_type>().Value == static_hash<ts>()) || ...)) {
+            static_assert(((kind_of<ts>() == kind_of<type_list_element_t<0, type_list<ts...>>>()) && ...),
+                          "Traversed types must be stored in the same bucket");
+            for (auto& ptr : _graph.m_buckets[kind_of<type_list_element_t<0, type_list<ts...>>>()].Elements) {
+                if (ptr && (is_a<ts>(*ptr) || ...)) {
                     _callback(*static_cast<base_object*>(ptr.get()));
                 }
             }
@@ -143,32 +379,157 @@ class graph : public object<graph<underlying_type>>
     };
 
   public:
+    // sample is whether an event from _source to _target should be recorded, decided by the GP_sampler policy
+    // before anything is created, the policy must be set before recording starts
+    bool sample(const underlying_type& _source, const underlying_type& _target) const
+    {
+        if (!this->template has<GP_sampler<underlying_type>>())
+            return true;
+        const auto& policy = this->template get<GP_sampler<underlying_type>>().Value;
+        return !policy || policy->sample(_source, _target);
+    }
+
     // new_object is to create a new object with auto-allocated handle
     template<typename t>
     t& new_object()
     {
         static_assert(std::is_base_of_v<base_object, t>, "T must be a derived class of base_object");
-        auto _handle = m_handle_manager.allocate();
-        auto ptr = std::make_unique<t>();
-        t& ref = *ptr;
-        m_elements.push_back(std::move(ptr));
-        ref.m_handle = std::make_shared<handle<underlying_type>>(_handle.id());
-        ref.template set<OP_type>(static_hash<t>());
-        return ref;
+        return emplace_object<t>(m_handle_manager.allocate());
+    }
+
+    // new_link is to create a link from _source to _target, when GP_aggregate_links is set an existing link with the
+    // same source, target, name and style is returned instead with its LP_count incremented, the key properties of
+    // an aggregated link must not be changed afterwards
+    link& new_link(const base_object& _source,
+                   const base_object& _target,
+                   std::string_view _name = {},
+                   enum_type _style = LP_style::k_solid | LP_style::k_arrow_mask)
+    {
+        return new_link(_source.get_handle_ref(), _target.get_handle_ref(), _name, _style);
+    }
+
+    // new_link is to create a link between the referenced objects like new_link between objects
+    link& new_link(const handle_ref& _source,
+                   const handle_ref& _target,
+                   std::string_view _name = {},
+                   enum_type _style = LP_style::k_solid | LP_style::k_arrow_mask)
+    {
+        const bool aggregate = aggregates_links();
+        const interned_string name = m_strings->intern(_name);
+        if (aggregate) {
+            auto iter = m_link_keys.find(link_key{ _source, _target, name, _style });
+            if (iter != m_link_keys.end()) {
+                if (link* existing = find_link(iter->second)) {
+                    ++existing->template get<LP_count>().Value;
+                    return *existing;
+                }
+                m_link_keys.erase(iter);
+            }
+        }
+
+        // the participants are referenced before creating the link, which may evict them in bounded graphs
+        pin_message_refs(_source, _target, 1);
+        link& created = new_object<link>();
+        pin_message_refs(_source, _target, -1);
+        created.template set<LP_source>(_source).template set<LP_target>(_target).template set<LP_style>(_style);
+        if (!name.empty())
+            created.template set<OP_name>(name);
+        if (aggregate) {
+            created.template set<LP_count>(1);
+            m_link_keys.emplace(link_key{ _source, _target, name, _style }, created.get_handle_ref());
+        }
+        return created;
+    }
+
+    // reserve is to make room for _nodes more nodes and _links more links, so creating them doesn't grow storage
+    void reserve(std::size_t _nodes, std::size_t _links)
+    {
+        const std::size_t count = _nodes + _links;
+        m_handle_manager.reserve(count);
+        m_handle_table->reserve(count);
+        m_index.reserve(count);
+        for (auto [kind, more] : { std::pair{ k_node, _nodes }, std::pair{ k_message, _links } }) {
+            m_buckets[kind].Elements.reserve(m_buckets[kind].Elements.size() + more);
+            m_buckets[kind].Sequences.reserve(m_buckets[kind].Sequences.size() + more);
+        }
+        if (_nodes != 0)
+            pool_of<node>().reserve(_nodes);
+        if (_links != 0)
+            pool_of<link>().reserve(_links);
+    }
+
+    // new_nodes is to create a node named by _name for every element of the range in one pass, storage of sized ranges
+    // is reserved up front and handle ids are taken as one block, returns the references to the nodes in range order
+    template<std::ranges::input_range range, typename name_projection = std::identity>
+    std::vector<handle_ref> new_nodes(range&& _range, name_projection _name = {})
+    {
+        std::vector<handle_ref> refs;
+        std::size_t count = 0;
+        if constexpr (std::ranges::sized_range<range>) {
+            count = std::ranges::size(_range);
+            reserve(count, 0);
+            refs.reserve(count);
+        }
+        auto block = m_handle_manager.allocate_block(count);
+        for (auto&& element : _range) {
+            decltype(auto) name = std::invoke(_name, element);
+            static_assert(std::is_convertible_v<decltype(name), std::string_view>, "Node names must be strings");
+            node& created = emplace_object<node>(m_handle_manager.allocate(block));
+            created.template get_or_create<OP_name>().Value = m_strings->intern(std::string_view(name));
+            refs.push_back(created.get_handle_ref());
+        }
+        return refs;
+    }
+
+    // new_links is to create a link from _source to _target of every element of the range in one pass, named by
+    // _label unless it is empty, the ends are objects of this graph or references to them, storage of sized ranges is
+    // reserved up front and handle ids are taken as one block, aggregating and bounded graphs create links one by one
+    template<std::ranges::input_range range,
+             typename source_projection,
+             typename target_projection,
+             typename label_projection = no_label>
+    void new_links(range&& _range,
+                   source_projection _source,
+                   target_projection _target,
+                   label_projection _label = {})
+    {
+        const bool one_by_one = aggregates_links() || message_capacity() != 0;
+        std::size_t count = 0;
+        if constexpr (std::ranges::sized_range<range>) {
+            count = std::ranges::size(_range);
+            if (!one_by_one)
+                reserve(0, count);
+        }
+        auto block = m_handle_manager.allocate_block(one_by_one ? 0 : count);
+        for (auto&& element : _range) {
+            const handle_ref source = ref_of(std::invoke(_source, element));
+            const handle_ref target = ref_of(std::invoke(_target, element));
+            decltype(auto) label = std::invoke(_label, element);
+            static_assert(std::is_convertible_v<decltype(label), std::string_view>, "Link labels must be strings");
+            const std::string_view name = label;
+            if (one_by_one) {
+                new_link(source, target, name);
+                continue;
+            }
+            link& created = emplace_object<link>(m_handle_manager.allocate(block));
+            created.template set<LP_source>(source).template set<LP_target>(target).template set<LP_style>(
+              LP_style::k_solid | LP_style::k_arrow_mask);
+            if (!name.empty())
+                created.template get_or_create<OP_name>().Value = m_strings->intern(name);
+        }
     }
 
     // access is to access a object by handle
     template<typename t>
     t& access(const handle<underlying_type>& _handle)
     {
-        for (auto& ptr : m_elements) {
-            if (ptr->template get<OP_type>().Value == static_hash<t>()) {
-                if (static_cast<handle<underlying_type>*>(ptr->get_handle().get())->id() == _handle.id()) {
-                    return *static_cast<t*>(ptr.get());
-                }
-            }
+        const element_location* location = m_index.find(_handle.id());
+        if (location && location->Kind == kind_of<t>()) {
+            auto& ptr = m_buckets[location->Kind].Elements[location->Slot];
+            if (ptr->template is<t>())
+                return *static_cast<t*>(ptr.get());
         }
-        throw std::runtime_error(std::format("Object not found: {}", _handle.id()));
+        throw std::runtime_error(std::format("Object not found: {}", _handle.print()));
     }
 
     // access is to access a object by handle
@@ -178,39 +539,890 @@ class graph : public object<graph<underlying_type>>
         return const_cast<graph<underlying_type>*>(this)->access<t>(_handle);
     }
 
+    // contains is whether an object is bound to the handle
+    bool contains(const handle<underlying_type>& _handle) const { return m_index.contains(_handle.id()); }
+
     // new_object_at is to create a new object with specific handle
     template<typename t>
     t& new_object_at(const handle<underlying_type>& _handle)
     {
-        if (m_handle_manager.is_allocated(_handle))
+        static_assert(std::is_base_of_v<base_object, t>, "T must be a derived class of base_object");
+        if (!m_handle_manager.allocate_at(_handle))
             throw std::runtime_error("Handle already allocated");
-        auto ptr = std::make_unique<t>();
-        t& ref = *ptr;
-        m_elements.push_back(std::move(ptr));
-        m_handle_manager.allocate_at(_handle);
-        ref.m_handle = std::make_shared<handle<underlying_type>>(_handle.id());
-        ref.template set<OP_type>(static_hash<t>());
+        return emplace_object<t>(_handle);
+    }
+
+    // delete_object is to delete an object by handle, links and notes left referencing a deleted node still print
+    // its handle
+    void delete_object(const handle<underlying_type>& _handle) { erase_object(_handle, true); }
+
+    // retired_ref is a reference printing the handle like a reference to a deleted node, no object is bound to it,
+    // it must be set on an object before the next delete or it may be dropped
+    handle_ref retired_ref(const handle<underlying_type>& _handle)
+    {
+        auto retired = std::allocate_shared<handle<underlying_type>>(m_handle_allocator, _handle.id());
+        const handle_ref ref = m_handle_table->bind(*retired);
+        m_handle_table->retire(std::move(retired));
         return ref;
     }
 
-    // delete_object is to delete an object by handle
-    void delete_object(const handle<underlying_type>& _handle)
+  private:
+    // erase_object is to delete an object by handle, the handle of a node is retired in the handle table if
+    // _keep_printable so references to it still render
+    void erase_object(const handle<underlying_type>& _handle, bool _keep_printable)
     {
-        if (!m_handle_manager.is_allocated(_handle))
+        const element_location* location = m_index.find(_handle.id());
+        if (!location)
             throw std::runtime_error("Handle not allocated");
-        m_elements.erase(
-          std::remove_if(m_elements.begin(),
-                         m_elements.end(),
-                         [&_handle](const std::unique_ptr<base_object>& ptr) {
-                             return static_cast<handle<underlying_type>*>(ptr->get_handle().get())->id() ==
-                                    _handle.id();
-                         }),
-          m_elements.end());
+        auto& bucket = m_buckets[location->Kind];
+        const base_object& object = *bucket.Elements[location->Slot];
+        if (location->Kind == k_message && object.template has<LP_count>())
+            forget_link_key(object);
+        if (location->Kind == k_message && bucket.Sequences[location->Slot] <= m_counted_sequence) {
+            release_message_refs(object);
+        } else if (location->Kind == k_node) {
+            const handle_ref ref = object.get_handle_ref();
+            if (ref.serial() < m_message_refs.size())
+                m_message_refs[ref.serial()] = 0;
+        }
+        const bool retire = _keep_printable && location->Kind == k_node;
+        if (retire)
+            m_handle_table->retire(object.get_handle());
+        else
+            m_handle_table->unbind(*object.get_handle());
+        bucket.Elements[location->Slot].reset();
+        m_index.erase(_handle.id());
         m_handle_manager.deallocate(_handle);
+        if (retire)
+            sweep_retired();
+
+        // deleted slots are left empty to keep the insertion order, compact once they are the majority
+        if (++bucket.EmptySlots * 2 > bucket.Elements.size())
+            compact(bucket);
+    }
+
+    // element_kind is the bucket an object is stored in, one per render phase
+    enum element_kind : std::size_t
+    {
+        k_class_def,
+        k_node,
+        k_message,
+        k_other,
+        k_element_kind_count,
+    };
+
+    // element_ptr is owning pointer to a pooled object
+    using element_ptr = std::unique_ptr<base_object, pool_deleter<base_object>>;
+
+    // element_bucket is insertion ordered storage of objects of one kind, deleted objects leave empty slots
+    struct element_bucket
+    {
+        std::vector<element_ptr> Elements;
+        std::vector<std::uint64_t> Sequences;
+        std::size_t EmptySlots = 0;
+        std::size_t Head = 0;
+    };
+
+    // element_location is the bucket and slot an object is stored at
+    struct element_location
+    {
+        element_kind Kind;
+        std::size_t Slot;
+    };
+
+    // kind_of is the bucket objects of type t are stored in
+    template<typename t>
+    static constexpr element_kind kind_of()
+    {
+        if constexpr (std::is_base_of_v<class_def, t>)
+            return k_class_def;
+        else if constexpr (std::is_base_of_v<node, t>)
+            return k_node;
+        else if constexpr (std::is_base_of_v<link, t> || std::is_base_of_v<note, t>)
+            return k_message;
+        else
+            return k_other;
+    }
+
+    // is_a is whether the object is of type t, objects in the class definition and node buckets always are
+    template<typename t>
+    static bool is_a(const base_object& _object)
+    {
+        if constexpr (std::is_same_v<t, class_def> || std::is_same_v<t, node>)
+            return true;
+        else
+            return _object.template is<t>();
+    }
+
+    // render_phase is a section of the rendered graph, each phase renders the objects of one bucket in order
+    enum render_phase : std::size_t
+    {
+        k_render_class_defs,
+        k_render_nodes,
+        k_render_messages,
+        k_render_classes,
+    };
+
+    // string_appender is the output iterator renders into a string go through, cached fragments are appended to the
+    // string in bulk rather than character by character
+    class string_appender
+    {
+      public:
+        using difference_type = std::ptrdiff_t;
+
+        explicit string_appender(std::string& _string)
+          : m_string(&_string)
+        {
+        }
+
+        string_appender& operator=(char _char)
+        {
+            m_string->push_back(_char);
+            return *this;
+        }
+        string_appender& operator*() { return *this; }
+        string_appender& operator++() { return *this; }
+        string_appender operator++(int) { return *this; }
+
+        // append is to write the text at once
+        void append(std::string_view _text) { m_string->append(_text); }
+
+      private:
+        std::string* m_string;
+    };
+
+    // slices of a parallel render are at least this many slots, each worker gets a few of them per phase
+    static constexpr std::size_t k_min_slice_size = 1024;
+    static constexpr std::size_t k_slices_per_worker = 4;
+
+    // bucket_of is the bucket rendered by the phase
+    static constexpr element_kind bucket_of(render_phase _phase)
+    {
+        switch (_phase) {
+            case k_render_class_defs:
+                return k_class_def;
+            case k_render_messages:
+                return k_message;
+            default:
+                return k_node;
+        }
+    }
+
+    // make_context is the render context described by the graph properties
+    render_context make_context() const
+    {
+        if (!this->template has<GP_type<underlying_type>>())
+            throw std::runtime_error("Graph type not set, please set it before calling to_string");
+        render_context context;
+        context.GraphType = this->template get<GP_type<underlying_type>>().Value;
+        if (this->template has<GP_output_format<underlying_type>>())
+            context.OutputFormat = this->template get<GP_output_format<underlying_type>>().Value;
+        if (this->template has<GP_incremental_render<underlying_type>>())
+            context.CacheFragments = this->template get<GP_incremental_render<underlying_type>>().Value;
+        return context;
+    }
+
+    // lock_fragments is to take the fragment caches of the objects for a render that uses them, renders on several
+    // threads may read the graph at once but only one of them fills the caches at a time
+    std::unique_lock<std::mutex> lock_fragments(const render_context& _context) const
+    {
+        if (!_context.CacheFragments)
+            return {};
+        return std::unique_lock<std::mutex>(*m_fragment_mutex);
+    }
+
+    // render_prologue is to write the fence, title, graph info and configuration info
+    template<typename output_iterator>
+    output_iterator render_prologue(output_iterator _out, const render_context& _context) const
+    {
+        switch (_context.OutputFormat) {
+            case graph_output_format::k_markdown:
+                _out = std::format_to(_out, "```mermaid\n");
+                break;
+            default:
+                break;
+        }
+
+        // Title
+        if (this->template has<OP_name>()) {
+            _out = std::format_to(_out, "---\ntitle: {}\n---\n", this->template _V_view<OP_name>());
+        }
+
+        // Graph info
+        _out = std::format_to(_out,
+                              "{} {}\n",
+                              this->template _V_str<GP_type<underlying_type>>(_context),
+                              this->template _V_str<GP_flowchart_direction<underlying_type>>(_context));
+
+        // Configuration info
+        return std::format_to(
+          _out, "{}\n", this->template _V_str<GP_sequence_show_number<underlying_type>>(_context));
+    }
+
+    // render_epilogue is to write the closing fence
+    template<typename output_iterator>
+    output_iterator render_epilogue(output_iterator _out, const render_context& _context) const
+    {
+        switch (_context.OutputFormat) {
+            case graph_output_format::k_markdown:
+                _out = std::format_to(_out, "```\n");
+                break;
+            default:
+                break;
+        }
+        return _out;
+    }
+
+    // render_phase_to is to render the objects of the phase stored in slots [_begin, _end) of its bucket
+    template<typename output_iterator>
+    output_iterator render_phase_to(output_iterator _out,
+                                    render_phase _phase,
+                                    std::size_t _begin,
+                                    std::size_t _end,
+                                    const render_context& _context) const
+    {
+        const auto& elements = m_buckets[bucket_of(_phase)].Elements;
+        for (std::size_t slot = _begin; slot < _end; ++slot) {
+            const base_object* object = elements[slot].get();
+            if (!object)
+                continue;
+            switch (_phase) {
+                // Forward declare class definitions
+                case k_render_class_defs:
+                    _out = render_object(_out, *static_cast<const class_def*>(object), _context);
+                    *_out++ = '\n';
+                    break;
+                // Draw nodes
+                case k_render_nodes:
+                    _out = render_object(_out, *static_cast<const node*>(object), _context);
+                    *_out++ = '\n';
+                    break;
+                // Draw links and notes
+                case k_render_messages:
+                    if (is_a<link>(*object) || is_a<note>(*object)) {
+                        _out = render_element<link, note>(_out, *object, _context);
+                        *_out++ = '\n';
+                    }
+                    break;
+                // Assign node names to class definitions
+                case k_render_classes: {
+                    const node* node = static_cast<const periscope::node*>(object);
+                    if (node->has<NP_class_def>()) {
+                        _out = std::format_to(_out,
+                                              "class {} {}Class\n",
+                                              node->get_handle()->print(_context),
+                                              node->template _V_view<NP_class_def>());
+                    }
+                    break;
+                }
+            }
+        }
+        return _out;
+    }
+
+    // render_object is to render the object, copying its cached fragment when the context caches fragments
+    template<typename t, typename output_iterator>
+    static output_iterator render_object(output_iterator _out, const t& _object, const render_context& _context)
+    {
+        if (!_context.CacheFragments)
+            return _object.render_to(_out, _context);
+        const std::string& text =
+          _object.fragment(_context, [&_object, &_context](auto _buffer) { _object.render_to(_buffer, _context); });
+        if constexpr (std::is_same_v<output_iterator, string_appender>) {
+            _out.append(text);
+            return _out;
+        } else {
+            return std::ranges::copy(text, _out).out;
+        }
+    }
+
+    // render_element is to render an object whose type is one of ts without virtual dispatch, its dense type index is
+    // compared inline like visit does, so the render of each type is inlined
+    template<typename... ts, typename output_iterator>
+    static output_iterator render_element(output_iterator _out,
+                                          const base_object& _object,
+                                          const render_context& _context)
+    {
+        const std::size_t index = _object.type_index();
+        (void)((index == object_types::index<ts>() &&
+                (_out = render_object(_out, static_cast<const ts&>(_object), _context), true)) ||
+               ...);
+        return _out;
+    }
+
+    // ref_of is the reference to an end of a link created by new_links
+    static handle_ref ref_of(const base_object& _object) { return _object.get_handle_ref(); }
+    static handle_ref ref_of(const handle_ref& _ref) { return _ref; }
+
+    // visited_types are the types visited by visit<ts...>, all registered object types if none are given
+    template<typename... ts>
+    using visited_types = std::conditional_t<sizeof...(ts) == 0, object_types::list_type, type_list<ts...>>;
+
+    // visit_objects is to call _callback with every object of the graph whose type is one of ts, bucket by bucket
+    template<typename self, typename... ts, typename callback>
+    static void visit_objects(self& _graph, type_list<ts...>, callback& _callback)
+    {
+        using object_type = std::conditional_t<std::is_const_v<self>, const base_object, base_object>;
+        for (std::size_t kind = 0; kind < k_element_kind_count; ++kind) {
+            if (((kind_of<ts>() != kind) && ...))
+                continue;
+            for (const auto& ptr : _graph.m_buckets[kind].Elements) {
+                if (!ptr)
+                    continue;
+                object_type& object = *ptr;
+                // the first type of the bucket the object is of gets it
+                (void)((kind_of<ts>() == kind && is_a<ts>(object) &&
+                        (_callback(static_cast<std::conditional_t<std::is_const_v<self>, const ts&, ts&>>(object)),
+                         true)) ||
+                       ...);
+            }
+        }
+    }
+
+    // pool_of is the pool objects of type t are allocated from
+    template<typename t>
+    object_pool<t, base_object>& pool_of()
+    {
+        base_object_pool<base_object>** cached = nullptr;
+        if constexpr (object_types::contains<t>) {
+            cached = &m_typed_pools[object_types::index<t>()];
+            if (*cached)
+                return static_cast<object_pool<t, base_object>&>(**cached);
+        }
+
+        base_object_pool<base_object>* found = nullptr;
+        for (auto& [type, pool] : m_pools) {
+            if (type == static_hash<t>()) {
+                found = pool.get();
+                break;
+            }
+        }
+        if (!found) {
+            m_pools.emplace_back(static_hash<t>(), std::make_unique<object_pool<t, base_object>>());
+            found = m_pools.back().second.get();
+        }
+        if (cached)
+            *cached = found;
+        return static_cast<object_pool<t, base_object>&>(*found);
+    }
+
+    // emplace_object is to append a new object bound to the handle
+    template<typename t>
+    t& emplace_object(const handle<underlying_type>& _handle)
+    {
+        if constexpr (kind_of<t>() == k_message)
+            count_message_refs();
+        auto& pool = pool_of<t>();
+        element_ptr ptr(pool.create(), pool_deleter<base_object>{ &pool });
+        t& ref = static_cast<t&>(*ptr);
+        ref.m_handle = std::allocate_shared<handle<underlying_type>>(m_handle_allocator, _handle.id());
+        ref.m_handle_table = m_handle_table.get();
+        ref.m_string_pool = m_strings.get();
+        m_handle_table->bind(*ref.m_handle);
+        auto& bucket = m_buckets[kind_of<t>()];
+        m_index.emplace(_handle.id(), element_location{ kind_of<t>(), bucket.Elements.size() });
+        bucket.Elements.push_back(std::move(ptr));
+        bucket.Sequences.push_back(++m_sequence);
+        if constexpr (kind_of<t>() == k_message)
+            evict_messages();
+        if constexpr (kind_of<t>() == k_node) {
+            if (message_capacity() != 0)
+                m_new_participants.emplace_back(m_sequence, ref.get_handle_ref());
+        }
+        return ref;
+    }
+
+    // message_capacity is the number of links and notes kept by the graph, 0 if unbounded
+    std::size_t message_capacity() const
+    {
+        if (!this->template has<GP_message_capacity<underlying_type>>())
+            return 0;
+        return this->template get<GP_message_capacity<underlying_type>>().Value;
+    }
+
+    // for_each_message_ref is to call _callback with every participant referenced by the link or note
+    template<typename callback>
+    static void for_each_message_ref(const base_object& _object, const callback& _callback)
+    {
+        if (_object.template has<LP_source>())
+            _callback(_object.template get<LP_source>().Value);
+        if (_object.template has<LP_target>())
+            _callback(_object.template get<LP_target>().Value);
+        if (_object.template has<MNP_basis>()) {
+            for (const handle_ref& ref : _object.template get<MNP_basis>().Value)
+                _callback(ref);
+        }
+    }
+
+    // for_each_ref is to call _callback with every handle referenced by the object
+    template<typename callback>
+    static void for_each_ref(const base_object& _object, const callback& _callback)
+    {
+        for_each_message_ref(_object, _callback);
+        if (_object.template has<NP_subgraph_node>()) {
+            for (const handle_ref& ref : _object.template get<NP_subgraph_node>().Value)
+                _callback(ref);
+        }
+    }
+
+    // sweep_retired is to drop the retired handles no object references anymore, once they outnumber both twice the
+    // ones the last sweep kept and the objects scanned, so a delete costs amortized constant time
+    void sweep_retired()
+    {
+        if (m_handle_table->retired_count() <= m_retired_limit)
+            return;
+        std::vector<handle_ref> referenced;
+        for (const auto& bucket : m_buckets) {
+            for (const element_ptr& object : bucket.Elements) {
+                if (!object)
+                    continue;
+                for_each_ref(*object, [this, &referenced](const handle_ref& _ref) {
+                    if (_ref.valid() && !m_handle_table->find(_ref))
+                        referenced.push_back(_ref);
+                });
+            }
+        }
+        m_handle_table->prune_retired(referenced);
+        m_retired_limit = std::max({ k_min_retired_sweep, 2 * m_handle_table->retired_count(), object_count() });
+    }
+
+    // release_message_refs is to uncount the participants of a counted message, the ones left unused become orphans
+    void release_message_refs(const base_object& _object)
+    {
+        for_each_message_ref(_object, [this](const handle_ref& _ref) {
+            if (!m_handle_table->find(_ref) || _ref.serial() >= m_message_refs.size())
+                return;
+            auto& count = m_message_refs[_ref.serial()];
+            if (count > 0 && --count == 0)
+                m_orphans.push_back(_ref);
+        });
+    }
+
+    // count_message_refs is to count the participants of the messages created since the last call, they are
+    // complete by the time the next one is created
+    void count_message_refs()
+    {
+        if (message_capacity() == 0)
+            return;
+
+        const auto& bucket = m_buckets[k_message];
+        auto first = std::upper_bound(bucket.Sequences.begin(), bucket.Sequences.end(), m_counted_sequence);
+        for (auto slot = static_cast<std::size_t>(first - bucket.Sequences.begin()); slot < bucket.Elements.size();
+             ++slot) {
+            if (!bucket.Elements[slot])
+                continue;
+            for_each_message_ref(*bucket.Elements[slot], [this](const handle_ref& _ref) {
+                if (!m_handle_table->find(_ref))
+                    return;
+                if (_ref.serial() >= m_message_refs.size())
+                    m_message_refs.resize(_ref.serial() + 1);
+                ++m_message_refs[_ref.serial()];
+            });
+        }
+        m_counted_sequence = m_sequence;
+    }
+
+    // evict_messages is to delete the oldest links and notes until the capacity is met, then the participants
+    // they were the last messages of and the ones no message referenced before the window moved past them
+    void evict_messages()
+    {
+        const std::size_t capacity = message_capacity();
+        if (capacity == 0)
+            return;
+
+        auto& bucket = m_buckets[k_message];
+        while (bucket.Elements.size() - bucket.EmptySlots > capacity) {
+            while (!bucket.Elements[bucket.Head])
+                ++bucket.Head;
+            auto* oldest = static_cast<handle<underlying_type>*>(bucket.Elements[bucket.Head]->get_handle().get());
+            erase_object(handle<underlying_type>(oldest->id()), false);
+        }
+
+        for (const handle_ref& ref : m_orphans) {
+            const base_handle* orphan = m_handle_table->find(ref);
+            if (!orphan || m_message_refs[ref.serial()] != 0)
+                continue;
+            handle<underlying_type> orphan_handle(static_cast<const handle<underlying_type>*>(orphan)->id());
+            const element_location* location = m_index.find(orphan_handle.id());
+            if (location && location->Kind == k_node)
+                erase_object(orphan_handle, false);
+        }
+        m_orphans.clear();
+
+        while (bucket.Head < bucket.Elements.size() && !bucket.Elements[bucket.Head])
+            ++bucket.Head;
+        if (bucket.Head == bucket.Elements.size())
+            return;
+        const std::uint64_t oldest = bucket.Sequences[bucket.Head];
+        for (; !m_new_participants.empty() && m_new_participants.front().first < oldest;
+             m_new_participants.pop_front()) {
+            const handle_ref ref = m_new_participants.front().second;
+            const base_handle* participant = m_handle_table->find(ref);
+            if (!participant || (ref.serial() < m_message_refs.size() && m_message_refs[ref.serial()] != 0))
+                continue;
+            handle<underlying_type> participant_handle(
+              static_cast<const handle<underlying_type>*>(participant)->id());
+            const element_location* location = m_index.find(participant_handle.id());
+            if (location && location->Kind == k_node)
+                erase_object(participant_handle, false);
+        }
+    }
+
+    // link_key is the key an aggregated link is stored under, the name is interned in the string pool of the graph so
+    // keys are compared and hashed without reading it
+    struct link_key
+    {
+        handle_ref Source;
+        handle_ref Target;
+        interned_string Name;
+        enum_type Style;
+
+        friend bool operator==(const link_key& _lhs, const link_key& _rhs) = default;
+    };
+
+    // link_key_hash is hash of link keys, the name is hashed once when it is interned
+    struct link_key_hash
+    {
+        std::size_t operator()(const link_key& _key) const
+        {
+            std::size_t hash = _key.Name.hash();
+            for (std::uint64_t part : { std::uint64_t{ _key.Source.serial() } << 32 | _key.Source.generation(),
+                                        std::uint64_t{ _key.Target.serial() } << 32 | _key.Target.generation(),
+                                        std::uint64_t{ _key.Style } }) {
+                hash ^= std::hash<std::uint64_t>{}(part) + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+            }
+            return hash;
+        }
+    };
+
+    // aggregates_links is whether new_link aggregates identical links
+    bool aggregates_links() const
+    {
+        return this->template has<GP_aggregate_links<underlying_type>>() &&
+               this->template get<GP_aggregate_links<underlying_type>>().Value;
+    }
+
+    // find_link is the link referenced, nullptr if it was deleted
+    link* find_link(const handle_ref& _ref)
+    {
+        const base_handle* bound = m_handle_table->find(_ref);
+        if (!bound)
+            return nullptr;
+        const element_location* location =
+          m_index.find(static_cast<const handle<underlying_type>*>(bound)->id());
+        if (!location || location->Kind != k_message)
+            return nullptr;
+        base_object* object = m_buckets[k_message].Elements[location->Slot].get();
+        return is_a<link>(*object) ? static_cast<link*>(object) : nullptr;
+    }
+
+    // name_of is the interned name of a link, empty if it is unnamed
+    static interned_string name_of(const base_object& _link)
+    {
+        return _link.template has<OP_name>() ? _link.template get<OP_name>().Value : interned_string();
+    }
+
+    // key_of is the key of an aggregated link, which has both ends
+    static link_key key_of(const base_object& _link)
+    {
+        const enum_type style = _link.template has<LP_style>() ? _link.template get<LP_style>().Value
+                                                                : LP_style::k_solid | LP_style::k_arrow_mask;
+        return link_key{
+            _link.template get<LP_source>().Value, _link.template get<LP_target>().Value, name_of(_link), style
+        };
+    }
+
+    // forget_link_key is to remove the key of an aggregated link being deleted
+    void forget_link_key(const base_object& _link)
+    {
+        if (!_link.template has<LP_source>() || !_link.template has<LP_target>())
+            return;
+        auto iter = m_link_keys.find(key_of(_link));
+        if (iter != m_link_keys.end() && iter->second == _link.get_handle_ref())
+            m_link_keys.erase(iter);
+    }
+
+    // restore_link_keys is to register the keys of the aggregated links of a loaded graph, so new_link counts into
+    // them instead of creating identical links
+    void restore_link_keys()
+    {
+        if (!aggregates_links())
+            return;
+        for (const auto& ptr : m_buckets[k_message].Elements) {
+            if (ptr && is_a<link>(*ptr) && ptr->template has<LP_count>() && ptr->template has<LP_source>() &&
+                ptr->template has<LP_target>())
+                m_link_keys.try_emplace(key_of(*ptr), ptr->get_handle_ref());
+        }
+    }
+
+    // pin_message_refs is to add _delta to the use counts of the participants of a bounded graph
+    void pin_message_refs(const handle_ref& _source, const handle_ref& _target, int _delta)
+    {
+        if (message_capacity() == 0)
+            return;
+        for (const handle_ref& ref : { _source, _target }) {
+            if (!ref.valid())
+                continue;
+            if (ref.serial() >= m_message_refs.size())
+                m_message_refs.resize(ref.serial() + 1);
+            m_message_refs[ref.serial()] += _delta;
+        }
+    }
+
+    // restore_object is to create the object of a snapshot record
+    base_object& restore_object(const snapshot_object_view& _record)
+    {
+        return object_types::visit(_record.type_index(), [this, &_record]<typename t>() -> base_object& {
+            return new_object_at<t>(handle<underlying_type>(_record.template handle_id<underlying_type>()));
+        });
+    }
+
+    // restore_properties is to give the object created for a snapshot record its properties
+    static void restore_properties(const snapshot_object_view& _record,
+                                   base_object& _object,
+                                   const std::vector<handle_ref>& _refs)
+    {
+        object_types::visit(_record.type_index(), [&_record, &_object, &_refs]<typename t>() {
+            restore_snapshot_properties<base_object>(_record, _object, _refs);
+            restore_snapshot_properties<t>(_record, _object, _refs);
+        });
+    }
+
+    // incoming_object is an object of another graph being merged into this one
+    struct incoming_object
+    {
+        element_ptr Object;
+        underlying_type Id;
+        handle_ref Ref;
+        element_kind Kind;
+    };
+
+    // remapped_ref is where a reference of the merged graph points in this graph, indexed by its serial, serials of
+    // the merged graph that weren't bound have no valid Ref
+    struct remapped_ref
+    {
+        std::uint32_t Generation = 0;
+        handle_ref Ref;
+    };
+
+    // object_count is the number of live objects of the graph
+    std::size_t object_count() const
+    {
+        std::size_t size = 0;
+        for (const auto& bucket : m_buckets)
+            size += bucket.Elements.size() - bucket.EmptySlots;
+        return size;
+    }
+
+    // id_of is the handle id of an object of this graph
+    static underlying_type id_of(const base_object& _object)
+    {
+        return static_cast<const handle<underlying_type>&>(*_object.get_handle()).id();
+    }
+
+    // copy_object is to copy an object of a registered type from the pools of this graph
+    element_ptr copy_object(const base_object& _object)
+    {
+        if (_object.type_index() == object_types::size)
+            throw std::runtime_error("Object type not supported by merge");
+        // the strings of the copy are interned into this graph rather than the shared pool
+        string_pool* outer = std::exchange(base_object::copy_pool(), m_strings.get());
+        guard restore([outer] { base_object::copy_pool() = outer; });
+        return object_types::visit(_object.type_index(), [this, &_object]<typename t>() {
+            auto& pool = pool_of<t>();
+            return element_ptr(pool.create(static_cast<const t&>(_object)), pool_deleter<base_object>{ &pool });
+        });
+    }
+
+    // adopt is to bind the objects of another graph to this one and append them to their buckets, references between
+    // them are rewritten through the serials of the graph they come from, references to nodes retired there are
+    // retired here too
+    void adopt(std::vector<incoming_object>& _incoming, const handle_table& _from, merge_policy _policy)
+    {
+        std::vector<remapped_ref> remapped;
+        std::unordered_map<std::uint64_t, handle_ref> retired;
+        auto bind = [this, &remapped](incoming_object& _object, const handle<underlying_type>& _handle) {
+            base_object& object = *_object.Object;
+            object.m_handle = std::allocate_shared<handle<underlying_type>>(m_handle_allocator, _handle.id());
+            object.m_handle_table = m_handle_table.get();
+            object.m_fragments.reset();
+            intern_strings(object);
+            map_ref(remapped, _object.Ref, m_handle_table->bind(*object.m_handle));
+        };
+
+        // ids free here are kept before new ids are allocated, so the new ones can't take them
+        std::vector<std::size_t> colliding;
+        for (std::size_t i = 0; i < _incoming.size(); ++i) {
+            incoming_object& object = _incoming[i];
+            if (const element_location* existing = m_index.find(object.Id)) {
+                if (_policy == merge_policy::k_unify && existing->Kind == k_node && object.Kind == k_node) {
+                    map_ref(remapped, object.Ref, m_buckets[k_node].Elements[existing->Slot]->get_handle_ref());
+                    object.Object.reset();
+                } else {
+                    colliding.push_back(i);
+                }
+            } else if (m_handle_manager.allocate_at(handle<underlying_type>(object.Id))) {
+                bind(object, handle<underlying_type>(object.Id));
+            } else {
+                colliding.push_back(i);
+            }
+        }
+        for (std::size_t i : colliding)
+            bind(_incoming[i], m_handle_manager.allocate());
+
+        const bool aggregate = aggregates_links();
+        for (incoming_object& object : _incoming) {
+            if (!object.Object)
+                continue;
+            rewrite_refs(*object.Object, [&](const handle_ref& _ref) {
+                if (_ref.valid() && _ref.serial() < remapped.size() && remapped[_ref.serial()].Ref.valid() &&
+                    remapped[_ref.serial()].Generation == _ref.generation())
+                    return remapped[_ref.serial()].Ref;
+                const base_handle* stale = _from.find_retired(_ref);
+                if (!stale)
+                    return handle_ref();
+                auto [iter, inserted] =
+                  retired.try_emplace(std::uint64_t{ _ref.serial() } << 32 | _ref.generation());
+                if (inserted)
+                    iter->second = retire_ref(static_cast<const handle<underlying_type>*>(stale)->id(), _policy);
+                return iter->second;
+            });
+            if (aggregate && object.Kind == k_message && is_a<link>(*object.Object) &&
+                object.Object->template has<LP_count>() && aggregate_link(static_cast<link&>(*object.Object))) {
+                const auto& bound = static_cast<const handle<underlying_type>&>(*object.Object->get_handle());
+                m_handle_table->unbind(bound);
+                m_handle_manager.deallocate(bound);
+                continue;
+            }
+
+            auto& bucket = m_buckets[object.Kind];
+            m_index.emplace(id_of(*object.Object), element_location{ object.Kind, bucket.Elements.size() });
+            if (object.Kind == k_node && message_capacity() != 0)
+                m_new_participants.emplace_back(m_sequence + 1, object.Object->get_handle_ref());
+            bucket.Elements.push_back(std::move(object.Object));
+            bucket.Sequences.push_back(++m_sequence);
+        }
+
+        count_message_refs();
+        evict_messages();
+    }
+
+    // retire_ref is the reference to a node retired in a merged graph, the live node of the same id under
+    // merge_policy::k_unify, else a handle retired in this graph which keeps the id for printing
+    handle_ref retire_ref(const underlying_type& _id, merge_policy _policy)
+    {
+        const element_location* existing = m_index.find(_id);
+        if (_policy == merge_policy::k_unify && existing && existing->Kind == k_node)
+            return m_buckets[k_node].Elements[existing->Slot]->get_handle_ref();
+        return retired_ref(handle<underlying_type>(_id));
+    }
+
+    // intern_strings is to move the string properties of an object of another graph into the string pool of this
+    // graph, so they outlive the other graph and compare equal to the strings of this one
+    void intern_strings(base_object& _object)
+    {
+        _object.m_string_pool = m_strings.get();
+        _object.template intern_strings<base_object>();
+        if (_object.type_index() != object_types::size)
+            object_types::visit(_object.type_index(),
+                                [&_object]<typename t>() { _object.template intern_strings<t>(); });
+        _object.m_own_strings.reset();
+    }
+
+    // map_ref is to record where a reference of the merged graph points in this graph
+    static void map_ref(std::vector<remapped_ref>& _remapped, const handle_ref& _from, const handle_ref& _to)
+    {
+        if (!_from.valid())
+            return;
+        if (_from.serial() >= _remapped.size())
+            _remapped.resize(_from.serial() + 1);
+        _remapped[_from.serial()] = remapped_ref{ _from.generation(), _to };
+    }
+
+    // rewrite_refs is to replace every reference to a participant, target or subgraph member held by the object
+    template<typename remap>
+    static void rewrite_refs(base_object& _object, const remap& _remap)
+    {
+        if (_object.template has<LP_source>())
+            _object.template get<LP_source>().Value = _remap(_object.template get<LP_source>().Value);
+        if (_object.template has<LP_target>())
+            _object.template get<LP_target>().Value = _remap(_object.template get<LP_target>().Value);
+        if (_object.template has<MNP_basis>()) {
+            for (handle_ref& ref : _object.template get<MNP_basis>().Value)
+                ref = _remap(ref);
+        }
+        if (_object.template has<NP_subgraph_node>()) {
+            for (handle_ref& ref : _object.template get<NP_subgraph_node>().Value)
+                ref = _remap(ref);
+        }
+    }
+
+    // aggregate_link is to add the count of a merged aggregated link to the link of this graph with the same key,
+    // false if there is none and the link is kept as the one of its key
+    bool aggregate_link(link& _link)
+    {
+        const link_key key = key_of(_link);
+        auto iter = m_link_keys.find(key);
+        if (iter != m_link_keys.end()) {
+            if (link* existing = find_link(iter->second)) {
+                existing->template get<LP_count>().Value += _link.template get<LP_count>().Value;
+                return true;
+            }
+            m_link_keys.erase(iter);
+        }
+        m_link_keys.emplace(key, _link.get_handle_ref());
+        return false;
+    }
+
+    // compact is to remove empty slots of the bucket and reindex the moved objects
+    void compact(element_bucket& _bucket)
+    {
+        auto& elements = _bucket.Elements;
+        std::size_t slot = 0;
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+            if (!elements[i])
+                continue;
+            m_index.find(static_cast<handle<underlying_type>*>(elements[i]->get_handle().get())->id())->Slot = slot;
+            if (slot != i) {
+                elements[slot] = std::move(elements[i]);
+                _bucket.Sequences[slot] = _bucket.Sequences[i];
+            }
+            ++slot;
+        }
+        elements.resize(slot);
+        _bucket.Sequences.resize(slot);
+        _bucket.EmptySlots = 0;
+        _bucket.Head = 0;
     }
 
   private:
     handle_manager<underlying_type> m_handle_manager;
-    std::vector<std::unique_ptr<base_object>> m_elements;
+    pool_allocator<handle<underlying_type>> m_handle_allocator;
+    std::unique_ptr<handle_table> m_handle_table = std::make_unique<handle_table>();
+
+    // held by renders filling the fragment caches of the objects
+    std::unique_ptr<std::mutex> m_fragment_mutex = std::make_unique<std::mutex>();
+
+    // labels, class names and colors of the objects, interned so repeated ones are stored once
+    std::unique_ptr<string_pool> m_strings = std::make_unique<string_pool>();
+    std::vector<std::pair<type_hash_result, std::unique_ptr<base_object_pool<base_object>>>> m_pools;
+    std::array<base_object_pool<base_object>*, object_types::size> m_typed_pools{};
+    std::array<element_bucket, k_element_kind_count> m_buckets;
+    std::uint64_t m_sequence = 0;
+
+    // retired handles kept before the next sweep
+    static constexpr std::size_t k_min_retired_sweep = 64;
+    std::size_t m_retired_limit = k_min_retired_sweep;
+
+    // participant use counts of bounded graphs, indexed by handle table serial, and their participants by creation
+    // sequence until the window moves past them
+    std::vector<std::uint32_t> m_message_refs;
+    std::vector<handle_ref> m_orphans;
+    std::deque<std::pair<std::uint64_t, handle_ref>> m_new_participants;
+    std::uint64_t m_counted_sequence = 0;
+    handle_index<underlying_type, element_location> m_index;
+
+    // links of aggregating graphs by key
+    std::unordered_map<link_key, handle_ref, link_key_hash> m_link_keys;
 };
 }
\ No newline at end of file
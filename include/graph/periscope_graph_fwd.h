@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace periscope {
 // ------------------------ Main template -----------------------
 
@@ -17,17 +19,27 @@ enum class graph_output_format
     k_markdown,
 };
 
-// graph_io_context is context for graph io
-struct graph_io_context
+// merge_policy is how graph::merge treats an object whose handle id is already bound in the target graph
+enum class merge_policy
 {
-    graph_type GraphType;
+    // the object gets a new handle
+    k_remap,
+    // a node is the same node as the one bound to its id and is merged into it, other objects get a new handle
+    k_unify,
 };
 
-// io is to get graph io context
-inline graph_io_context&
-io()
+// render_context is per-render state passed through every render call, so graphs can be rendered concurrently
+struct render_context
 {
-    static graph_io_context _instance;
-    return _instance;
-}
+    graph_type GraphType = graph_type::k_flowchart;
+    graph_output_format OutputFormat = graph_output_format::k_markdown;
+    bool CacheFragments = false;
+};
+
+// render_cursor is position of an incremental render, a default constructed cursor starts before the header
+struct render_cursor
+{
+    std::uint64_t Sequence = 0;
+    bool HeaderWritten = false;
+};
 } // namespace periscope
\ No newline at end of file
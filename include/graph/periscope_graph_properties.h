@@ -2,6 +2,9 @@
 
 #include "graph/periscope_graph_fwd.h"
 #include "object/periscope_object_properties.h"
+#include "tools/periscope_sampler.h"
+#include <cstddef>
+#include <memory>
 
 namespace periscope {
 // ------------------------ Main template -----------------------
@@ -18,9 +21,9 @@ template<typename underlying_type>
 struct GP_sequence_show_number : base_property<bool, graph<underlying_type>>
 {
     using parent_properties = type_list<GP_type<underlying_type>>;
-    static std::string to_string(const GP_sequence_show_number& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const GP_sequence_show_number& _property, const render_context& _context = {})
     {
-        switch (_graph_type) {
+        switch (_context.GraphType) {
             case graph_type::k_sequence:
                 return _property.template base_property<bool, graph<underlying_type>>::Value ? "autonumber" : "";
             default:
@@ -35,7 +38,7 @@ struct GP_type : base_property<graph_type, graph<underlying_type>>
 {
     using child_properties = type_list<GP_sequence_show_number<underlying_type>>;
 
-    static std::string to_string(const GP_type& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const GP_type& _property, const render_context& _context = {})
     {
         switch (_property.Value) {
             case graph_type::k_flowchart:
@@ -53,6 +56,29 @@ template<typename underlying_type>
 struct GP_output_format : base_property<graph_output_format, graph<underlying_type>>
 {};
 
+// GP_incremental_render is property for whether objects keep their rendered text and only re-render after changes
+template<typename underlying_type>
+struct GP_incremental_render : base_property<bool, graph<underlying_type>>
+{};
+
+// GP_message_capacity is property for the number of most recent links and notes kept, creating one beyond it evicts
+// the oldest and drops the participants left without messages or created before all kept messages without being
+// referenced by one, so look participants up after creating a message
+template<typename underlying_type>
+struct GP_message_capacity : base_property<std::size_t, graph<underlying_type>>
+{};
+
+// GP_aggregate_links is property for whether new_link keeps one link per source, target, name and style, counting
+// the identical links created instead of storing them
+template<typename underlying_type>
+struct GP_aggregate_links : base_property<bool, graph<underlying_type>>
+{};
+
+// GP_sampler is property for the sampling policy deciding which events are recorded into the graph
+template<typename underlying_type>
+struct GP_sampler : base_property<std::shared_ptr<sampler<underlying_type>>, graph<underlying_type>>
+{};
+
 // GP_flowchart_direction is property for graph flowchart direction
 template<typename underlying_type>
 struct GP_flowchart_direction : base_property<enum_type, graph<underlying_type>>
@@ -65,9 +91,9 @@ struct GP_flowchart_direction : base_property<enum_type, graph<underlying_type>>
         k_right_to_left,
     };
 
-    static std::string to_string(const GP_flowchart_direction& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const GP_flowchart_direction& _property, const render_context& _context = {})
     {
-        if (_graph_type != graph_type::k_flowchart)
+        if (_context.GraphType != graph_type::k_flowchart)
             return "";
         switch (_property.Value) {
             case flowchart_direction::k_top_to_down:
@@ -83,4 +109,18 @@ struct GP_flowchart_direction : base_property<enum_type, graph<underlying_type>>
         }
     }
 };
+
+// property_set is specialization for graph properties
+template<typename underlying_type>
+struct property_set<graph<underlying_type>>
+{
+    using type = type_list<GP_type<underlying_type>,
+                           GP_sequence_show_number<underlying_type>,
+                           GP_output_format<underlying_type>,
+                           GP_flowchart_direction<underlying_type>,
+                           GP_incremental_render<underlying_type>,
+                           GP_message_capacity<underlying_type>,
+                           GP_sampler<underlying_type>,
+                           GP_aggregate_links<underlying_type>>;
+};
 }
\ No newline at end of file
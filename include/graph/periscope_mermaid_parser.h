@@ -0,0 +1,545 @@
+#pragma once
+
+#include "graph/periscope_graph.h"
+#include <charconv>
+#include <cstdint>
+#include <format>
+#include <istream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// mermaid_parser is streaming parser rebuilding a graph from the mermaid text periscope renders, text is fed in chunks
+// of any size and parsed line by line, lines outside of what periscope renders are rejected
+template<typename underlying_type>
+class mermaid_parser
+{
+  public:
+    explicit mermaid_parser(graph<underlying_type>& _graph)
+      : m_graph(_graph)
+    {
+    }
+
+    // feed is to parse the next chunk of text, lines may be split across chunks
+    mermaid_parser& feed(std::string_view _chunk)
+    {
+        while (!_chunk.empty()) {
+            const std::size_t end = _chunk.find('\n');
+            if (end == std::string_view::npos) {
+                m_partial.append(_chunk);
+                break;
+            }
+            if (m_partial.empty()) {
+                parse_line(_chunk.substr(0, end));
+            } else {
+                m_partial.append(_chunk.substr(0, end));
+                parse_line(m_partial);
+                m_partial.clear();
+            }
+            _chunk.remove_prefix(end + 1);
+        }
+        return *this;
+    }
+
+    // finish is to parse the last line and resolve the subgraph members, which may be declared after the subgraph
+    graph<underlying_type>& finish()
+    {
+        if (!m_partial.empty()) {
+            parse_line(m_partial);
+            m_partial.clear();
+        }
+        if (m_state == k_subgraph)
+            throw std::runtime_error("Unterminated mermaid subgraph");
+        if (m_fenced && m_state != k_done)
+            throw std::runtime_error("Unterminated mermaid code fence");
+
+        flush_class_defs();
+        for (auto& subgraph : m_subgraphs) {
+            auto& members = subgraph.Node->template get_or_create<NP_subgraph_node>().Value;
+            members.reserve(subgraph.Members.size());
+            for (const std::string& member : subgraph.Members)
+                members.push_back(find_node(member));
+        }
+        m_subgraphs.clear();
+        return m_graph;
+    }
+
+  private:
+    // parse_state is the section of the text being parsed
+    enum parse_state
+    {
+        k_prologue,
+        k_front_matter,
+        k_body,
+        k_subgraph,
+        k_done,
+    };
+
+    // arrow_style is the style of a link rendered with the arrow
+    struct arrow_style
+    {
+        std::string_view Text;
+        enum_type Style;
+    };
+
+    // flowchart arrows are matched whole, or by their ends around a label
+    static constexpr arrow_style k_flowchart_arrows[] = {
+        { "-->", LP_style::k_solid | LP_style::k_arrow_mask },
+        { "--", LP_style::k_solid },
+        { "-.->", LP_style::k_dashed | LP_style::k_arrow_mask },
+        { "-.-", LP_style::k_dashed },
+        { "==>", LP_style::k_bold_solid | LP_style::k_arrow_mask },
+    };
+
+    // sequence arrows are matched by prefix, longest first, activation follows the arrow
+    static constexpr arrow_style k_sequence_arrows[] = {
+        { "-->>", LP_style::k_dashed | LP_style::k_arrow_mask },
+        { "-->", LP_style::k_dashed },
+        { "->>", LP_style::k_solid | LP_style::k_arrow_mask },
+        { "->", LP_style::k_solid },
+    };
+
+    // pending_class_def is a class definition created once all nodes are, so its handle can't take a node's id
+    struct pending_class_def
+    {
+        std::string Name;
+        std::optional<std::string> Fill;
+        std::optional<std::string> Stroke;
+        std::optional<std::string> Color;
+    };
+
+    // pending_subgraph is a subgraph whose members are resolved when parsing finishes
+    struct pending_subgraph
+    {
+        node* Node;
+        std::vector<std::string> Members;
+    };
+
+    // parse_line is to parse one line without its line break
+    void parse_line(std::string_view _line)
+    {
+        ++m_line;
+        if (!_line.empty() && _line.back() == '\r')
+            _line.remove_suffix(1);
+
+        switch (m_state) {
+            case k_prologue:
+                if (_line == "```mermaid") {
+                    m_fenced = true;
+                } else if (_line == "---") {
+                    m_state = k_front_matter;
+                } else if (!_line.empty()) {
+                    parse_header(_line);
+                }
+                return;
+            case k_front_matter:
+                if (_line == "---")
+                    m_state = k_prologue;
+                else if (_line.starts_with("title: "))
+                    m_graph.template set<OP_name>(std::string(_line.substr(7)));
+                else
+                    fail(_line);
+                return;
+            case k_subgraph:
+                if (_line == "end")
+                    m_state = k_body;
+                else
+                    m_subgraphs.back().Members.emplace_back(_line);
+                return;
+            case k_body:
+                if (_line.empty())
+                    return;
+                if (_line == "```" && m_fenced) {
+                    m_state = k_done;
+                } else if (_line == "autonumber") {
+                    m_graph.template set<GP_sequence_show_number>(true);
+                } else if (m_type == graph_type::k_flowchart) {
+                    parse_flowchart_line(_line);
+                } else {
+                    parse_sequence_line(_line);
+                }
+                return;
+            case k_done:
+                if (!_line.empty())
+                    fail(_line);
+                return;
+        }
+    }
+
+    // parse_header is to read the graph type and direction
+    void parse_header(std::string_view _line)
+    {
+        const std::string_view type = _line.substr(0, _line.find(' '));
+        const std::string_view direction = type.size() < _line.size() ? _line.substr(type.size() + 1) : "";
+        if (type == "flowchart") {
+            m_type = graph_type::k_flowchart;
+            using direction_type = GP_flowchart_direction<underlying_type>;
+            if (direction == "TD")
+                m_graph.template set<GP_flowchart_direction>(direction_type::k_top_to_down);
+            else if (direction == "BT")
+                m_graph.template set<GP_flowchart_direction>(direction_type::k_down_to_top);
+            else if (direction == "LR")
+                m_graph.template set<GP_flowchart_direction>(direction_type::k_left_to_right);
+            else if (direction == "RL")
+                m_graph.template set<GP_flowchart_direction>(direction_type::k_right_to_left);
+            else if (!direction.empty())
+                fail(_line);
+        } else if (type == "sequenceDiagram" && direction.empty()) {
+            m_type = graph_type::k_sequence;
+        } else {
+            fail(_line);
+        }
+        m_graph.template set<GP_type>(m_type);
+        m_graph.template set<GP_output_format>(m_fenced ? graph_output_format::k_markdown
+                                                        : graph_output_format::k_mermaid);
+        m_state = k_body;
+    }
+
+    // parse_flowchart_line is to parse a class definition, node, subgraph, link or class assignment
+    void parse_flowchart_line(std::string_view _line)
+    {
+        if (_line.starts_with("classDef ")) {
+            parse_class_def(_line);
+        } else if (_line.starts_with("subgraph ")) {
+            // subgraph ID["NAME"]
+            const std::size_t open = _line.find("[\"");
+            if (open == std::string_view::npos || !_line.ends_with("\"]"))
+                fail(_line);
+            node& subgraph = new_node(_line.substr(9, open - 9), _line.substr(open + 2, _line.size() - open - 4));
+            m_subgraphs.push_back(pending_subgraph{ &subgraph, {} });
+            m_state = k_subgraph;
+        } else if (_line.starts_with("class ")) {
+            // class ID NAMEClass
+            flush_class_defs();
+            const std::size_t space = _line.find(' ', 6);
+            if (space == std::string_view::npos || !_line.ends_with("Class"))
+                fail(_line);
+            std::string_view name = _line.substr(space + 1);
+            name.remove_suffix(5);
+            access_node(_line.substr(6, space - 6)).template set<NP_class_def>(std::string(name));
+        } else if (const std::size_t at = _line.find("@{ shape: "); at != std::string_view::npos) {
+            // ID@{ shape: SHAPE, label: NAME }
+            const std::size_t label = _line.find(", label: ", at);
+            if (label == std::string_view::npos || !_line.ends_with(" }"))
+                fail(_line);
+            node& parsed = new_node(_line.substr(0, at), _line.substr(label + 9, _line.size() - label - 11));
+            const std::string_view shape = _line.substr(at + 10, label - at - 10);
+            if (shape == "diamond")
+                parsed.set<NP_shape>(NP_shape::k_diamond);
+            else if (shape == "parallelogram")
+                parsed.set<NP_shape>(NP_shape::k_parallelogram);
+            else if (shape != "rect")
+                fail(_line);
+        } else {
+            parse_flowchart_link(_line);
+        }
+    }
+
+    // parse_class_def is to read a class definition, classDef NAMEClass fill:F,stroke:S,color:C
+    void parse_class_def(std::string_view _line)
+    {
+        const std::size_t space = _line.find(' ', 9);
+        std::string_view name = _line.substr(9, space == std::string_view::npos ? _line.npos : space - 9);
+        if (!name.ends_with("Class"))
+            fail(_line);
+        name.remove_suffix(5);
+
+        pending_class_def parsed{ std::string(name), {}, {}, {} };
+        std::string_view styles = space == std::string_view::npos ? "" : _line.substr(space + 1);
+        while (!styles.empty()) {
+            const std::string_view style = styles.substr(0, styles.find(','));
+            styles.remove_prefix(std::min(styles.size(), style.size() + 1));
+            if (style.starts_with("fill:"))
+                parsed.Fill = std::string(style.substr(5));
+            else if (style.starts_with("stroke:"))
+                parsed.Stroke = std::string(style.substr(7));
+            else if (style.starts_with("color:"))
+                parsed.Color = std::string(style.substr(6));
+            else
+                fail(_line);
+        }
+        m_class_defs.push_back(std::move(parsed));
+    }
+
+    // parse_flowchart_link is to read SOURCE ARROW TARGET or SOURCE HEAD"LABEL"TAIL TARGET
+    void parse_flowchart_link(std::string_view _line)
+    {
+        const std::size_t first = _line.find(' ');
+        const std::size_t last = _line.rfind(' ');
+        if (first == std::string_view::npos || first == last)
+            fail(_line);
+        const std::string_view arrow = _line.substr(first + 1, last - first - 1);
+
+        // a label splits the arrow after its first two and before its last three characters, see link
+        std::optional<std::string_view> label;
+        if (arrow.size() >= 7 && arrow[2] == '"' && arrow[arrow.size() - 4] == '"')
+            label = arrow.substr(3, arrow.size() - 7);
+        const arrow_style* match = nullptr;
+        for (const arrow_style& candidate : k_flowchart_arrows) {
+            if (label ? candidate.Text.size() >= 3 && arrow.starts_with(candidate.Text.substr(0, 2)) &&
+                          arrow.ends_with(candidate.Text.substr(candidate.Text.size() - 3))
+                      : arrow == candidate.Text) {
+                match = &candidate;
+                break;
+            }
+        }
+        if (!match)
+            fail(_line);
+        const enum_type style = match->Style;
+
+        link& parsed = new_link(_line.substr(0, first), _line.substr(last + 1));
+        if (style != (LP_style::k_solid | LP_style::k_arrow_mask))
+            parsed.set<LP_style>(style);
+        if (label)
+            set_label(parsed, *label);
+    }
+
+    // parse_sequence_line is to parse a participant, message or note
+    void parse_sequence_line(std::string_view _line)
+    {
+        if (_line.starts_with("participant ")) {
+            // participant ID as NAME
+            const std::size_t as = _line.find(" as ", 12);
+            if (as == std::string_view::npos)
+                fail(_line);
+            new_node(_line.substr(12, as - 12), _line.substr(as + 4));
+            return;
+        }
+
+        flush_class_defs();
+        const std::size_t colon = _line.find(" : ");
+        if (colon == std::string_view::npos)
+            fail(_line);
+        const std::string_view text = _line.substr(colon + 3);
+        const std::string_view head = _line.substr(0, colon);
+
+        if (head.starts_with("Note ")) {
+            // Note left of ID : TEXT, Note right of ID : TEXT or Note over ID, ID : TEXT
+            note& parsed = new_object<note>();
+            auto& basis = parsed.get_or_create<MNP_basis>().Value;
+            if (head.starts_with("Note over ")) {
+                std::string_view ids = head.substr(10);
+                while (!ids.empty()) {
+                    const std::string_view id = ids.substr(0, ids.find(", "));
+                    basis.push_back(find_node(id));
+                    ids.remove_prefix(std::min(ids.size(), id.size() + 2));
+                }
+            } else if (head.starts_with("Note left of ")) {
+                basis.push_back(find_node(head.substr(13)));
+            } else if (head.starts_with("Note right of ")) {
+                parsed.set<MNP_orient>(MNP_orient::k_right);
+                basis.push_back(find_node(head.substr(14)));
+            } else {
+                fail(_line);
+            }
+            if (!text.empty())
+                parsed.set<OP_name>(std::string(text));
+            return;
+        }
+
+        // SOURCE ARROW[+-] TARGET : TEXT
+        const std::size_t first = head.find(' ');
+        const std::size_t last = head.rfind(' ');
+        if (first == std::string_view::npos || first == last)
+            fail(_line);
+        std::string_view arrow = head.substr(first + 1, last - first - 1);
+        const arrow_style* match = nullptr;
+        for (const arrow_style& candidate : k_sequence_arrows) {
+            if (arrow.starts_with(candidate.Text)) {
+                match = &candidate;
+                break;
+            }
+        }
+        if (!match)
+            fail(_line);
+        const enum_type style = match->Style;
+        arrow.remove_prefix(match->Text.size());
+
+        link& parsed = new_link(head.substr(0, first), head.substr(last + 1));
+        if (style != (LP_style::k_solid | LP_style::k_arrow_mask))
+            parsed.set<LP_style>(style);
+        if (arrow == "+")
+            parsed.set<LP_activate>(true);
+        else if (arrow == "-")
+            parsed.set<LP_activate>(false);
+        else if (!arrow.empty())
+            fail(_line);
+        if (!text.empty())
+            set_label(parsed, text);
+    }
+
+    // set_label is to set the name and count of a link, aggregated links end their label with (xN), or are only xN
+    static void set_label(link& _link, std::string_view _label)
+    {
+        const auto count_of = [](std::string_view _digits) -> std::uint64_t {
+            std::uint64_t count = 0;
+            auto [end, error] = std::from_chars(_digits.data(), _digits.data() + _digits.size(), count);
+            return error == std::errc() && end == _digits.data() + _digits.size() && count > 1 ? count : 0;
+        };
+        if (_label.ends_with(")")) {
+            const std::size_t open = _label.rfind(" (x");
+            if (open != std::string_view::npos) {
+                if (std::uint64_t count = count_of(_label.substr(open + 3, _label.size() - open - 4))) {
+                    _link.set<LP_count>(count);
+                    _link.set<OP_name>(std::string(_label.substr(0, open)));
+                    return;
+                }
+            }
+        } else if (_label.starts_with("x")) {
+            if (std::uint64_t count = count_of(_label.substr(1))) {
+                _link.set<LP_count>(count);
+                return;
+            }
+        }
+        _link.set<OP_name>(std::string(_label));
+    }
+
+    // new_node is to create a named node at the handle printed as _id
+    node& new_node(std::string_view _id, std::string_view _name)
+    {
+        node& created = m_graph.template new_object_at<node>(handle<underlying_type>(parse_id(_id)));
+        created.set<OP_name>(std::string(_name));
+        m_nodes.insert_or_assign(std::string(_id), created.get_handle_ref());
+        return created;
+    }
+
+    // new_link is to create a link between the nodes printed as _source and _target
+    link& new_link(std::string_view _source, std::string_view _target)
+    {
+        flush_class_defs();
+        const handle_ref source = find_node(_source);
+        const handle_ref target = find_node(_target);
+        link& created = new_object<link>();
+        created.set<LP_source>(source).template set<LP_target>(target);
+        return created;
+    }
+
+    // new_object is to create an object with an auto-allocated handle
+    template<typename t>
+    t& new_object()
+    {
+        return m_graph.template new_object<t>();
+    }
+
+    // flush_class_defs is to create the class definitions read so far, once the nodes are created
+    void flush_class_defs()
+    {
+        for (auto& pending : m_class_defs) {
+            class_def& created = new_object<class_def>();
+            created.set<OP_name>(std::move(pending.Name));
+            if (pending.Fill)
+                created.set<MCD_fill>(std::move(*pending.Fill));
+            if (pending.Stroke)
+                created.set<MCD_stroke>(std::move(*pending.Stroke));
+            if (pending.Color)
+                created.set<MCD_color>(std::move(*pending.Color));
+        }
+        m_class_defs.clear();
+    }
+
+    // access_node is the node printed as _id
+    node& access_node(std::string_view _id)
+    {
+        return m_graph.template access<node>(handle<underlying_type>(parse_id(_id)));
+    }
+
+    // find_node is the reference to the node printed as _id, ids no node was declared with are references to deleted
+    // nodes and print the same, even if an object parsed later took the id
+    handle_ref find_node(std::string_view _id)
+    {
+        auto [found, inserted] = m_nodes.try_emplace(std::string(_id));
+        if (inserted)
+            found->second = m_graph.retired_ref(handle<underlying_type>(parse_id(_id)));
+        return found->second;
+    }
+
+    // parse_id is the handle id printed as _text, see handle::print
+    underlying_type parse_id(std::string_view _text) const
+    {
+        if constexpr (std::is_same_v<underlying_type, std::string>) {
+            return std::string(_text);
+        } else {
+            std::string_view digits = _text;
+            if (m_type == graph_type::k_sequence && digits.starts_with("OBJ"))
+                digits.remove_prefix(3);
+            if constexpr (std::is_integral_v<underlying_type>) {
+                return parse_number<underlying_type>(digits, _text, 10);
+            } else if constexpr (std::is_pointer_v<underlying_type>) {
+                if (!digits.starts_with("0x"))
+                    throw std::runtime_error(std::format("Unexpected mermaid handle: {}", _text));
+                return reinterpret_cast<underlying_type>(parse_number<std::uintptr_t>(digits.substr(2), _text, 16));
+            } else if constexpr (std::is_same_v<underlying_type, slot_id>) {
+                if (m_type == graph_type::k_flowchart && digits.starts_with("S"))
+                    digits.remove_prefix(1);
+                const std::size_t separator = digits.find('_');
+                if (separator == std::string_view::npos)
+                    throw std::runtime_error(std::format("Unexpected mermaid handle: {}", _text));
+                return slot_id{ parse_number<std::uint32_t>(digits.substr(0, separator), _text, 10),
+                                parse_number<std::uint32_t>(digits.substr(separator + 1), _text, 10) };
+            } else {
+                static_assert(sizeof(underlying_type) == 0, "Handle type not supported by the mermaid parser");
+            }
+        }
+    }
+
+    // parse_number is the number spelled by all of _digits
+    template<typename number>
+    static number parse_number(std::string_view _digits, std::string_view _text, int _base)
+    {
+        number value{};
+        auto [end, error] = std::from_chars(_digits.data(), _digits.data() + _digits.size(), value, _base);
+        if (error != std::errc() || end != _digits.data() + _digits.size() || _digits.empty())
+            throw std::runtime_error(std::format("Unexpected mermaid handle: {}", _text));
+        return value;
+    }
+
+    // fail is to reject a line periscope doesn't render
+    [[noreturn]] void fail(std::string_view _line) const
+    {
+        throw std::runtime_error(std::format("Unsupported mermaid at line {}: {}", m_line, _line));
+    }
+
+    graph<underlying_type>& m_graph;
+    parse_state m_state = k_prologue;
+    graph_type m_type = graph_type::k_flowchart;
+    bool m_fenced = false;
+    std::size_t m_line = 0;
+    std::string m_partial;
+    std::vector<pending_class_def> m_class_defs;
+    std::vector<pending_subgraph> m_subgraphs;
+
+    // references to the nodes by the id they are printed as, declared or deleted
+    std::unordered_map<std::string, handle_ref> m_nodes;
+};
+
+// parse_mermaid is to build a graph from the mermaid text periscope renders
+template<typename underlying_type>
+graph<underlying_type>
+parse_mermaid(std::string_view _text)
+{
+    graph<underlying_type> parsed;
+    mermaid_parser<underlying_type>(parsed).feed(_text).finish();
+    return parsed;
+}
+
+// parse_mermaid is to build a graph from the mermaid text periscope renders, read from the stream in blocks
+template<typename underlying_type>
+graph<underlying_type>
+parse_mermaid(std::istream& _stream)
+{
+    graph<underlying_type> parsed;
+    mermaid_parser<underlying_type> parser(parsed);
+    std::string block(1 << 16, '\0');
+    while (_stream.read(block.data(), static_cast<std::streamsize>(block.size())) || _stream.gcount() > 0)
+        parser.feed(std::string_view(block.data(), static_cast<std::size_t>(_stream.gcount())));
+    parser.finish();
+    return parsed;
+}
+}
\ No newline at end of file
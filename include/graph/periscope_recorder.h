@@ -0,0 +1,287 @@
+#pragma once
+
+#include "graph/periscope_graph.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// recorder is concurrent event sink for sequence graphs, every thread appends to its own buffer without locking
+// and flush merges the buffers into the graph ordered by time, then by thread, then by record order
+template<typename underlying_type>
+class recorder
+{
+  public:
+    explicit recorder(graph<underlying_type>& _graph)
+      : m_graph(_graph)
+      , m_id(next_recorder_id())
+      , m_alive(std::make_shared<char>())
+    {
+    }
+
+    recorder(const recorder&) = delete;
+    recorder& operator=(const recorder&) = delete;
+
+    // participant is to declare a participant, the first declaration of an id wins
+    void participant(const underlying_type& _id, std::string_view _name)
+    {
+        append(event_kind::k_participant, _id, _id, _name);
+    }
+
+    // message is to record a message between two participants, unless the sampler of the graph rejects it
+    void message(const underlying_type& _source, const underlying_type& _target, std::string_view _text)
+    {
+        if (!m_graph.sample(_source, _target))
+            return;
+        append(event_kind::k_message, _source, _target, _text);
+    }
+
+    // flush is to merge the events recorded so far into the graph
+    graph<underlying_type>& flush()
+    {
+        std::lock_guard<std::mutex> flush_lock(m_flush_mutex);
+
+        std::vector<thread_buffer*> buffers;
+        {
+            std::lock_guard<std::mutex> buffers_lock(m_buffers_mutex);
+            buffers.reserve(m_buffers.size());
+            for (auto& buffer : m_buffers)
+                buffers.push_back(buffer.get());
+        }
+
+        // buffers are drained in registration order, so sorting stably by time keeps thread and record order
+        std::vector<event> events;
+        std::string text;
+        for (auto* buffer : buffers)
+            buffer->drain(events, text);
+        std::stable_sort(events.begin(), events.end(), [](const event& _lhs, const event& _rhs) {
+            return _lhs.Timestamp < _rhs.Timestamp;
+        });
+
+        for (const auto& event : events)
+            apply(event, std::string_view(text).substr(event.TextOffset, event.TextSize));
+        return m_graph;
+    }
+
+    // to_string is to flush and convert the graph to string representation
+    std::string to_string() { return flush().to_string(); }
+
+  private:
+    // event_kind is the kind of a recorded event
+    enum class event_kind : std::uint8_t
+    {
+        k_participant,
+        k_message,
+    };
+
+    // event is a recorded event, its text (the name of participants) is a range of the text of the chunk it is
+    // recorded in, or of the text drained by flush
+    struct event
+    {
+        std::int64_t Timestamp = 0;
+        event_kind Kind = event_kind::k_message;
+        underlying_type Source{};
+        underlying_type Target{};
+        std::size_t TextOffset = 0;
+        std::size_t TextSize = 0;
+    };
+
+    // chunk is a fixed block of events and the bytes of their text, Count is published by the producer after the
+    // event and its text are written, a chunk isn't written anymore once Next is set
+    struct chunk
+    {
+        static constexpr std::size_t k_capacity = 256;
+        static constexpr std::size_t k_text_capacity = 16 * 1024;
+
+        explicit chunk(std::size_t _text_capacity = k_text_capacity)
+          : Text(std::make_unique_for_overwrite<char[]>(_text_capacity))
+          , TextCapacity(_text_capacity)
+        {
+        }
+
+        std::array<event, k_capacity> Events;
+        std::unique_ptr<char[]> Text;
+        std::size_t TextCapacity;
+        std::size_t TextSize = 0;
+        std::atomic<std::size_t> Count{ 0 };
+        std::atomic<chunk*> Next{ nullptr };
+    };
+
+    // thread_buffer is single producer, single consumer list of chunks owned by one recording thread
+    class thread_buffer
+    {
+      public:
+        thread_buffer()
+          : m_head(new chunk)
+          , m_tail(m_head)
+        {
+        }
+
+        thread_buffer(const thread_buffer&) = delete;
+        thread_buffer& operator=(const thread_buffer&) = delete;
+
+        ~thread_buffer()
+        {
+            while (m_head) {
+                chunk* next = m_head->Next.load(std::memory_order_relaxed);
+                delete m_head;
+                m_head = next;
+            }
+        }
+
+        // push is to append an event and copy its text into the chunk, only called by the owning thread, a chunk is
+        // allocated once the events or the text of the last one are full
+        void push(event _event, std::string_view _text)
+        {
+            chunk* tail = m_tail;
+            std::size_t count = tail->Count.load(std::memory_order_relaxed);
+            if (count == chunk::k_capacity || tail->TextCapacity - tail->TextSize < _text.size()) {
+                chunk* next = new chunk(std::max(chunk::k_text_capacity, _text.size()));
+                tail->Next.store(next, std::memory_order_release);
+                m_tail = tail = next;
+                count = 0;
+            }
+            std::copy(_text.begin(), _text.end(), tail->Text.get() + tail->TextSize);
+            _event.TextOffset = tail->TextSize;
+            _event.TextSize = _text.size();
+            tail->TextSize += _text.size();
+            tail->Events[count] = _event;
+            tail->Count.store(count + 1, std::memory_order_release);
+        }
+
+        // drain is to copy the published events out, their text is appended to _text, only called by the flushing
+        // thread
+        void drain(std::vector<event>& _events, std::string& _text)
+        {
+            while (true) {
+                // a chunk is left once the next one is linked, so its count read after the link is final
+                chunk* next = m_head->Next.load(std::memory_order_acquire);
+                std::size_t count = m_head->Count.load(std::memory_order_acquire);
+                for (; m_read < count; ++m_read) {
+                    event drained = m_head->Events[m_read];
+                    drained.TextOffset = _text.size();
+                    _text.append(m_head->Text.get() + m_head->Events[m_read].TextOffset, drained.TextSize);
+                    _events.push_back(drained);
+                }
+                if (!next)
+                    return;
+                delete m_head;
+                m_head = next;
+                m_read = 0;
+            }
+        }
+
+      private:
+        chunk* m_head;
+        std::size_t m_read = 0;
+        chunk* m_tail;
+    };
+
+    // next_recorder_id is to give every recorder an id that is never reused
+    static std::uint64_t next_recorder_id()
+    {
+        static std::atomic<std::uint64_t> next_id{ 1 };
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // local_entry is the buffer of a recorder used by the thread, Alive expires when the recorder is destroyed
+    struct local_entry
+    {
+        std::uint64_t Id = 0;
+        thread_buffer* Buffer = nullptr;
+        std::weak_ptr<const void> Alive;
+    };
+
+    // local_buffer is the buffer of the calling thread, registered on first use, the entries of destroyed recorders
+    // are dropped then
+    thread_buffer& local_buffer()
+    {
+        thread_local std::pair<std::uint64_t, thread_buffer*> last{ 0, nullptr };
+        thread_local std::vector<local_entry> buffers;
+        if (last.first == m_id)
+            return *last.second;
+
+        for (auto& entry : buffers) {
+            if (entry.Id == m_id) {
+                last = { entry.Id, entry.Buffer };
+                return *entry.Buffer;
+            }
+        }
+
+        thread_buffer* buffer = nullptr;
+        {
+            std::lock_guard<std::mutex> buffers_lock(m_buffers_mutex);
+            buffer = m_buffers.emplace_back(std::make_unique<thread_buffer>()).get();
+        }
+        std::erase_if(buffers, [](const local_entry& _entry) { return _entry.Alive.expired(); });
+        buffers.push_back(local_entry{ m_id, buffer, m_alive });
+        last = { m_id, buffer };
+        return *buffer;
+    }
+
+    // append is to record an event on the calling thread, the text is copied into the buffer of the thread
+    void append(event_kind _kind,
+                const underlying_type& _source,
+                const underlying_type& _target,
+                std::string_view _text)
+    {
+        local_buffer().push(
+          event{ std::chrono::steady_clock::now().time_since_epoch().count(), _kind, _source, _target }, _text);
+    }
+
+    // ensure_participant is the participant node for the id, created with its declared name, or its printed handle
+    // if it was never declared, when it is not in the graph
+    node& ensure_participant(const underlying_type& _id)
+    {
+        handle<underlying_type> _handle(_id);
+        if (m_graph.contains(_handle))
+            return m_graph.template access<node>(_handle);
+        node& participant = m_graph.template new_object_at<node>(_handle);
+        auto name = m_names.find(_id);
+        participant.template set<OP_name>(name != m_names.end()
+                                            ? name->second
+                                            : _handle.print(render_context{ graph_type::k_sequence }));
+        return participant;
+    }
+
+    // apply is to replay the event with its text on the graph
+    void apply(const event& _event, std::string_view _text)
+    {
+        switch (_event.Kind) {
+            case event_kind::k_participant: {
+                // names are kept, bounded graphs drop participants without messages and they may come back later
+                if (m_names.try_emplace(_event.Source, _text).second)
+                    ensure_participant(_event.Source);
+                break;
+            }
+            case event_kind::k_message: {
+                // new_link keeps the participants while the message is created and aggregates identical messages
+                const handle_ref source = ensure_participant(_event.Source).get_handle_ref();
+                const handle_ref target = ensure_participant(_event.Target).get_handle_ref();
+                m_graph.new_link(source, target, _text);
+                break;
+            }
+        }
+    }
+
+  private:
+    graph<underlying_type>& m_graph;
+    const std::uint64_t m_id;
+    std::shared_ptr<const void> m_alive;
+    std::mutex m_flush_mutex;
+    std::mutex m_buffers_mutex;
+    std::vector<std::unique_ptr<thread_buffer>> m_buffers;
+    std::unordered_map<underlying_type, std::string> m_names;
+};
+}
\ No newline at end of file
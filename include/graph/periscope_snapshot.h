@@ -0,0 +1,709 @@
+#pragma once
+
+#include "link/periscope_link.h"
+#include "misc/periscope_class_def.h"
+#include "misc/periscope_note.h"
+#include "node/periscope_node.h"
+#include "object/periscope_handle.h"
+#include "object/periscope_object.h"
+#include "object/periscope_object_properties.h"
+#include "type_hash/periscope_type_hash.h"
+#include "type_traits/periscope_type_list.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// snapshot_type_tag is the stable tag of the object type, its index in object_types plus one so it doesn't depend on
+// the compiler like static_hash does
+template<typename t>
+constexpr std::uint16_t
+snapshot_type_tag()
+{
+    static_assert(object_types::contains<t>, "Object type not supported by snapshots");
+    return static_cast<std::uint16_t>(object_types::index<t>()) + 1;
+}
+
+// k_snapshot_typed_property is the tag bit of properties declared by the object type rather than by base_object
+inline constexpr std::uint16_t k_snapshot_typed_property = 0x8000;
+
+// snapshot_property_tag is the stable tag of the property, its position in the property set of its owner, new
+// properties must only be appended to property sets
+template<typename prop>
+constexpr std::uint16_t
+snapshot_property_tag()
+{
+    using owner = typename prop::owner_type;
+    if constexpr (std::is_same_v<owner, base_object>)
+        return static_cast<std::uint16_t>(type_list_index_v<prop, property_set_t<base_object>>);
+    else
+        return k_snapshot_typed_property | static_cast<std::uint16_t>(type_list_index_v<prop, property_set_t<owner>>);
+}
+
+// snapshot_encoding is how the value of a property record is stored
+enum class snapshot_encoding : std::uint16_t
+{
+    k_none,
+    k_integer,
+    k_string,
+    k_ref,
+    k_ref_list,
+};
+
+// snapshot_encoding_of is the encoding of properties of the value type, k_none if they are not saved
+template<typename value_type>
+constexpr snapshot_encoding
+snapshot_encoding_of()
+{
+    if constexpr (std::is_integral_v<value_type> || std::is_enum_v<value_type>)
+        return snapshot_encoding::k_integer;
+    else if constexpr (std::is_same_v<value_type, interned_string>)
+        return snapshot_encoding::k_string;
+    else if constexpr (std::is_same_v<value_type, handle_ref>)
+        return snapshot_encoding::k_ref;
+    else if constexpr (std::is_same_v<value_type, std::vector<handle_ref>>)
+        return snapshot_encoding::k_ref_list;
+    else
+        return snapshot_encoding::k_none;
+}
+
+// snapshot_handle_kind is how the handle ids of object records are stored
+enum class snapshot_handle_kind : std::uint32_t
+{
+    k_integer = 1,
+    k_pointer,
+    k_string,
+    k_slot,
+};
+
+// snapshot_handle_kind_of is the handle kind of graphs with the underlying type
+template<typename underlying_type>
+constexpr snapshot_handle_kind
+snapshot_handle_kind_of()
+{
+    if constexpr (std::is_integral_v<underlying_type>)
+        return snapshot_handle_kind::k_integer;
+    else if constexpr (std::is_pointer_v<underlying_type>)
+        return snapshot_handle_kind::k_pointer;
+    else if constexpr (std::is_same_v<underlying_type, std::string>)
+        return snapshot_handle_kind::k_string;
+    else if constexpr (std::is_same_v<underlying_type, slot_id>)
+        return snapshot_handle_kind::k_slot;
+    else
+        static_assert(sizeof(underlying_type) == 0, "Handle type not supported by snapshots");
+}
+
+// snapshot_header is the start of a snapshot, sections follow at the offsets in the order listed, each 8-byte aligned
+struct snapshot_header
+{
+    std::array<char, 8> Magic;
+    std::uint32_t ByteOrder;
+    std::uint32_t Version;
+    snapshot_handle_kind HandleKind;
+    std::uint32_t GraphPropertyCount;
+    std::uint64_t ObjectCount;
+    std::uint64_t RetiredCount;
+    std::uint64_t PropertyCount;
+    std::uint64_t RefCount;
+    std::uint64_t StringSize;
+    std::uint64_t ObjectOffset;
+    std::uint64_t PropertyOffset;
+    std::uint64_t RefOffset;
+    std::uint64_t StringOffset;
+};
+
+// snapshot_object is the record of an object, its properties are a range of the property section, the records of the
+// retired handles still referenced follow the objects with no type and no properties
+struct snapshot_object
+{
+    std::uint32_t FirstProperty;
+    std::uint16_t TypeTag;
+    std::uint16_t PropertyCount;
+    std::uint64_t Handle;
+};
+
+// snapshot_property is the record of a property, strings and reference lists are packed as offset and size into the
+// string and reference sections, references are object indices, indices past the objects are retired handles
+struct snapshot_property
+{
+    std::uint16_t Tag;
+    snapshot_encoding Encoding;
+    std::uint32_t ValueLow;
+    std::uint32_t ValueHigh;
+
+    // value is the value of the record
+    std::uint64_t value() const { return static_cast<std::uint64_t>(ValueHigh) << 32 | ValueLow; }
+};
+
+inline constexpr std::array<char, 8> k_snapshot_magic{ 'P', 'E', 'R', 'I', 'S', 'N', 'A', 'P' };
+inline constexpr std::uint32_t k_snapshot_byte_order = 0x01020304;
+inline constexpr std::uint32_t k_snapshot_version = 2;
+
+// k_snapshot_null_ref is the object index of references to objects that were deleted and can't be printed anymore
+inline constexpr std::uint32_t k_snapshot_null_ref = ~std::uint32_t{ 0 };
+
+namespace internal {
+// align_snapshot_offset is the offset rounded up to the next section boundary
+constexpr std::size_t
+align_snapshot_offset(std::size_t _offset)
+{
+    return (_offset + 7) & ~std::size_t{ 7 };
+}
+}
+
+class snapshot_view;
+
+// snapshot_object_view is read-only view of an object record inside a snapshot, nothing is copied out of the snapshot
+class snapshot_object_view
+{
+  public:
+    snapshot_object_view(const snapshot_view& _snapshot,
+                         std::uint32_t _type_tag,
+                         std::uint64_t _handle,
+                         std::span<const snapshot_property> _properties)
+      : m_snapshot(&_snapshot)
+      , m_type_tag(_type_tag)
+      , m_handle(_handle)
+      , m_properties(_properties)
+    {
+    }
+
+    // type_tag is the stable type tag of the object, 0 for the graph itself
+    std::uint32_t type_tag() const { return m_type_tag; }
+
+    // type_index is the index of the type of the object in object_types
+    std::size_t type_index() const
+    {
+        if (m_type_tag == 0 || m_type_tag > object_types::size)
+            throw std::runtime_error("Object type not supported by snapshots");
+        return m_type_tag - 1;
+    }
+
+    // is is whether the object is of type t
+    template<typename t>
+    bool is() const
+    {
+        return m_type_tag == snapshot_type_tag<t>();
+    }
+
+    // handle_id is the id of the handle the object was bound to
+    template<typename underlying_type>
+    underlying_type handle_id() const;
+
+    // properties are the property records of the object
+    std::span<const snapshot_property> properties() const { return m_properties; }
+
+    // has is whether the property was saved
+    template<typename prop>
+    bool has() const
+    {
+        return find(snapshot_property_tag<prop>()) != nullptr;
+    }
+
+    // get is the saved value of the property, strings are views into the snapshot, references are object indices
+    template<typename prop>
+    auto get() const;
+
+  private:
+    // find is the record of the property tag, nullptr if it wasn't saved
+    const snapshot_property* find(std::uint16_t _tag) const
+    {
+        for (const snapshot_property& property : m_properties) {
+            if (property.Tag == _tag)
+                return &property;
+        }
+        return nullptr;
+    }
+
+    const snapshot_view* m_snapshot;
+    std::uint32_t m_type_tag;
+    std::uint64_t m_handle;
+    std::span<const snapshot_property> m_properties;
+};
+
+// snapshot_view is read-only view of a snapshot written by graph::save_snapshot, the bytes can come from a mapped
+// file and are only validated, objects are read in place on access
+class snapshot_view
+{
+  public:
+    // snapshot_view is to view _size bytes at _data, which must be 8-byte aligned and outlive the view
+    snapshot_view(const void* _data, std::size_t _size)
+      : m_data(static_cast<const char*>(_data))
+      , m_size(_size)
+    {
+        if (reinterpret_cast<std::uintptr_t>(_data) % alignof(std::uint64_t) != 0)
+            throw std::runtime_error("Snapshot data must be 8-byte aligned");
+        if (_size < sizeof(snapshot_header))
+            throw std::runtime_error("Snapshot truncated");
+        std::memcpy(&m_header, _data, sizeof(snapshot_header));
+        if (m_header.Magic != k_snapshot_magic)
+            throw std::runtime_error("Not a snapshot");
+        if (m_header.ByteOrder != k_snapshot_byte_order)
+            throw std::runtime_error("Snapshot written with a different byte order");
+        if (m_header.Version != k_snapshot_version)
+            throw std::runtime_error("Unsupported snapshot version");
+        if (m_header.GraphPropertyCount > m_header.PropertyCount ||
+            m_header.RetiredCount > ~std::uint64_t{ 0 } - m_header.ObjectCount ||
+            !fits(m_header.ObjectOffset, m_header.ObjectCount + m_header.RetiredCount, sizeof(snapshot_object)) ||
+            !fits(m_header.PropertyOffset, m_header.PropertyCount, sizeof(snapshot_property)) ||
+            !fits(m_header.RefOffset, m_header.RefCount, sizeof(std::uint32_t)) ||
+            !fits(m_header.StringOffset, m_header.StringSize, 1))
+            throw std::runtime_error("Snapshot truncated");
+    }
+
+    // snapshot_view is to view the bytes of a string holding a snapshot
+    explicit snapshot_view(std::string_view _bytes)
+      : snapshot_view(_bytes.data(), _bytes.size())
+    {
+    }
+
+    // header is the header of the snapshot
+    const snapshot_header& header() const { return m_header; }
+
+    // object_count is the number of objects saved
+    std::size_t object_count() const { return static_cast<std::size_t>(m_header.ObjectCount); }
+
+    // object is the view of the object at the index, objects are in the render order of the graph
+    snapshot_object_view object(std::size_t _index) const
+    {
+        if (_index >= object_count())
+            throw std::runtime_error("Snapshot object index out of range");
+        const snapshot_object& record = section<snapshot_object>(m_header.ObjectOffset)[_index];
+        if (record.FirstProperty > m_header.PropertyCount ||
+            record.PropertyCount > m_header.PropertyCount - record.FirstProperty)
+            throw std::runtime_error("Snapshot object properties out of range");
+        return snapshot_object_view(*this,
+                                    record.TypeTag,
+                                    record.Handle,
+                                    std::span(section<snapshot_property>(m_header.PropertyOffset) +
+                                                record.FirstProperty,
+                                              record.PropertyCount));
+    }
+
+    // retired_count is the number of retired handles saved, handles of deleted nodes still referenced by the objects
+    std::size_t retired_count() const { return static_cast<std::size_t>(m_header.RetiredCount); }
+
+    // retired is the view of the retired handle at the index, referenced as object index object_count() + _index,
+    // only its handle_id is set
+    snapshot_object_view retired(std::size_t _index) const
+    {
+        if (_index >= retired_count())
+            throw std::runtime_error("Snapshot retired handle index out of range");
+        const snapshot_object& record = section<snapshot_object>(m_header.ObjectOffset)[object_count() + _index];
+        return snapshot_object_view(*this, 0, record.Handle, {});
+    }
+
+    // graph_properties is the view of the properties of the graph itself
+    snapshot_object_view graph_properties() const
+    {
+        return snapshot_object_view(
+          *this, 0, 0, std::span(section<snapshot_property>(m_header.PropertyOffset), m_header.GraphPropertyCount));
+    }
+
+    // string is the string packed into a record value
+    std::string_view string(std::uint64_t _packed) const
+    {
+        const std::uint64_t offset = _packed >> 32;
+        const std::uint64_t size = _packed & 0xFFFFFFFFu;
+        if (offset + size > m_header.StringSize)
+            throw std::runtime_error("Snapshot string out of range");
+        return std::string_view(m_data + m_header.StringOffset + offset, size);
+    }
+
+    // refs are the object indices of the reference list packed into a record value
+    std::span<const std::uint32_t> refs(std::uint64_t _packed) const
+    {
+        const std::uint64_t offset = _packed >> 32;
+        const std::uint64_t size = _packed & 0xFFFFFFFFu;
+        if (offset + size > m_header.RefCount)
+            throw std::runtime_error("Snapshot reference list out of range");
+        return std::span(section<std::uint32_t>(m_header.RefOffset) + offset, size);
+    }
+
+  private:
+    // fits is whether _count records of _record_size bytes at the aligned _offset are inside the data
+    bool fits(std::uint64_t _offset, std::uint64_t _count, std::uint64_t _record_size) const
+    {
+        return _offset % alignof(std::uint64_t) == 0 && _offset <= m_size &&
+               _count <= (m_size - _offset) / _record_size;
+    }
+
+    // section is the records starting at the offset
+    template<typename record>
+    const record* section(std::uint64_t _offset) const
+    {
+        return reinterpret_cast<const record*>(m_data + _offset);
+    }
+
+    const char* m_data;
+    std::size_t m_size;
+    snapshot_header m_header;
+};
+
+template<typename underlying_type>
+underlying_type
+snapshot_object_view::handle_id() const
+{
+    if (m_snapshot->header().HandleKind != snapshot_handle_kind_of<underlying_type>())
+        throw std::runtime_error("Snapshot saved with a different handle type");
+    if constexpr (std::is_integral_v<underlying_type>)
+        return static_cast<underlying_type>(m_handle);
+    else if constexpr (std::is_pointer_v<underlying_type>)
+        return reinterpret_cast<underlying_type>(static_cast<std::uintptr_t>(m_handle));
+    else if constexpr (std::is_same_v<underlying_type, std::string>)
+        return std::string(m_snapshot->string(m_handle));
+    else
+        return slot_id{ static_cast<std::uint32_t>(m_handle), static_cast<std::uint32_t>(m_handle >> 32) };
+}
+
+template<typename prop>
+auto
+snapshot_object_view::get() const
+{
+    using value_type = typename prop::type;
+    constexpr snapshot_encoding encoding = snapshot_encoding_of<value_type>();
+    static_assert(encoding != snapshot_encoding::k_none, "Property not saved in snapshots");
+
+    const snapshot_property* property = find(snapshot_property_tag<prop>());
+    if (!property || property->Encoding != encoding)
+        throw std::runtime_error("Property not found");
+    if constexpr (encoding == snapshot_encoding::k_integer)
+        return static_cast<value_type>(property->value());
+    else if constexpr (encoding == snapshot_encoding::k_string)
+        return m_snapshot->string(property->value());
+    else if constexpr (encoding == snapshot_encoding::k_ref)
+        return property->ValueLow;
+    else
+        return m_snapshot->refs(property->value());
+}
+
+// snapshot_writer is to lay out the objects of a graph as a snapshot, objects are numbered and measured when added so
+// references can point to objects written later and the snapshot is written in place into the buffer
+template<typename underlying_type>
+class snapshot_writer
+{
+  public:
+    // snapshot_writer is to lay out objects bound in _handles, references to the handles retired there are kept
+    explicit snapshot_writer(const handle_table& _handles)
+      : m_handles(&_handles)
+    {
+    }
+
+    // add is to number and measure the object, objects are written in the order they are added
+    void add(const base_object& _object)
+    {
+        const handle_ref ref = _object.get_handle_ref();
+        if (ref.serial() >= m_numbers.size())
+            m_numbers.resize(ref.serial() + 1);
+        m_numbers[ref.serial()] = number{ ref.generation(), static_cast<std::uint32_t>(m_objects.size()) };
+        m_objects.push_back(&_object);
+        if (m_objects.size() >= k_snapshot_null_ref)
+            throw std::runtime_error("Too many objects for a snapshot");
+
+        if constexpr (std::is_same_v<underlying_type, std::string>)
+            m_string_size += static_cast<const handle<underlying_type>&>(*_object.get_handle()).id().size();
+        dispatch(_object, [this, &_object]<typename t>() {
+            measure<base_object>(_object);
+            measure<t>(_object);
+        });
+    }
+
+    // write is to append the snapshot of the graph properties and the added objects to the buffer
+    template<typename graph_type>
+    void write(const graph_type& _graph, std::string& _buffer)
+    {
+        measure<base_object>(_graph);
+        measure<graph_type>(_graph);
+        for (const base_object* object : m_objects) {
+            dispatch(*object, [this, object]<typename t>() {
+                number_retired<base_object>(*object);
+                number_retired<t>(*object);
+            });
+        }
+
+        snapshot_header header{};
+        header.Magic = k_snapshot_magic;
+        header.ByteOrder = k_snapshot_byte_order;
+        header.Version = k_snapshot_version;
+        header.HandleKind = snapshot_handle_kind_of<underlying_type>();
+        header.ObjectCount = m_objects.size();
+        header.RetiredCount = m_retired.size();
+        header.PropertyCount = m_property_count;
+        header.RefCount = m_ref_count;
+        header.StringSize = m_string_size;
+        header.ObjectOffset = internal::align_snapshot_offset(sizeof(snapshot_header));
+        header.PropertyOffset = internal::align_snapshot_offset(
+          header.ObjectOffset + (header.ObjectCount + header.RetiredCount) * sizeof(snapshot_object));
+        header.RefOffset =
+          internal::align_snapshot_offset(header.PropertyOffset + header.PropertyCount * sizeof(snapshot_property));
+        header.StringOffset =
+          internal::align_snapshot_offset(header.RefOffset + header.RefCount * sizeof(std::uint32_t));
+        if (header.PropertyCount > 0xFFFFFFFFu || header.RefCount > 0xFFFFFFFFu || header.StringSize > 0xFFFFFFFFu)
+            throw std::runtime_error("Too many properties for a snapshot");
+
+        // the snapshot is laid out relative to its own start, which is padded to a section boundary of the buffer
+        const std::size_t start = internal::align_snapshot_offset(_buffer.size());
+        _buffer.resize(start + header.StringOffset + header.StringSize);
+        char* out = _buffer.data() + start;
+        m_objects_out = out + header.ObjectOffset;
+        m_properties_out = out + header.PropertyOffset;
+        m_refs_out = out + header.RefOffset;
+        m_strings_out = out + header.StringOffset;
+
+        write_properties<base_object>(_graph);
+        write_properties<graph_type>(_graph);
+        header.GraphPropertyCount = m_next_property;
+        std::memcpy(out, &header, sizeof(header));
+
+        for (const base_object* object : m_objects) {
+            dispatch(*object, [this, object]<typename t>() {
+                const std::uint32_t first = m_next_property;
+                write_properties<base_object>(*object);
+                write_properties<t>(*object);
+                const auto& bound = static_cast<const handle<underlying_type>&>(*object->get_handle());
+                const snapshot_object record{ first,
+                                              snapshot_type_tag<t>(),
+                                              static_cast<std::uint16_t>(m_next_property - first),
+                                              encode_handle(bound.id()) };
+                std::memcpy(m_objects_out, &record, sizeof(record));
+                m_objects_out += sizeof(record);
+            });
+        }
+        for (const handle<underlying_type>* retired : m_retired) {
+            const snapshot_object record{ 0, 0, 0, encode_handle(retired->id()) };
+            std::memcpy(m_objects_out, &record, sizeof(record));
+            m_objects_out += sizeof(record);
+        }
+    }
+
+  private:
+    // number is the index an object was numbered with and the generation of its handle reference at the time
+    struct number
+    {
+        std::uint32_t Generation = 0;
+        std::uint32_t Index = k_snapshot_null_ref;
+    };
+
+    // dispatch is to call _callback with the type of the object through the visit table of its dense type index
+    template<typename callback>
+    static void dispatch(const base_object& _object, const callback& _callback)
+    {
+        if (_object.type_index() == object_types::size)
+            throw std::runtime_error("Object type not supported by snapshots");
+        object_types::visit(_object.type_index(), _callback);
+    }
+
+    // for_each_saved_property is to call _callback with the value of every saved property of the owner set the
+    // object has, the type is saved as its stable tag instead
+    template<typename owner, typename callback>
+    static void for_each_saved_property(const base_object& _object, const callback& _callback)
+    {
+        type_list_for_each(property_set_t<owner>{}, [&_object, &_callback]<typename prop>() {
+            if constexpr (snapshot_encoding_of<typename prop::type>() != snapshot_encoding::k_none &&
+                          !std::is_same_v<prop, OP_type>) {
+                if (_object.template has<prop>())
+                    _callback.template operator()<prop>(_object.template get<prop>().Value);
+            }
+        });
+    }
+
+    // measure is to count the records, references and string bytes of the saved properties of the owner set
+    template<typename owner>
+    void measure(const base_object& _object)
+    {
+        for_each_saved_property<owner>(_object, [this]<typename prop>(const typename prop::type& _value) {
+            ++m_property_count;
+            if constexpr (std::is_same_v<typename prop::type, interned_string>) {
+                if (m_string_offsets.emplace(_value.id(), k_unwritten).second)
+                    m_string_size += _value.size();
+            }
+            else if constexpr (std::is_same_v<typename prop::type, std::vector<handle_ref>>)
+                m_ref_count += _value.size();
+        });
+    }
+
+    // number_retired is to number the retired handles referenced by the saved properties of the owner set after the
+    // objects, each once
+    template<typename owner>
+    void number_retired(const base_object& _object)
+    {
+        auto number = [this](const handle_ref& _ref) {
+            if (index_of(_ref) != k_snapshot_null_ref)
+                return;
+            const base_handle* retired = m_handles->find_retired(_ref);
+            if (!retired)
+                return;
+            const auto index = static_cast<std::uint32_t>(m_objects.size() + m_retired.size());
+            m_retired_numbers.emplace(retired_key(_ref), index);
+            m_retired.push_back(static_cast<const handle<underlying_type>*>(retired));
+            if (m_objects.size() + m_retired.size() >= k_snapshot_null_ref)
+                throw std::runtime_error("Too many objects for a snapshot");
+            if constexpr (std::is_same_v<underlying_type, std::string>)
+                m_string_size += m_retired.back()->id().size();
+        };
+        for_each_saved_property<owner>(_object, [&number]<typename prop>(const typename prop::type& _value) {
+            if constexpr (std::is_same_v<typename prop::type, handle_ref>) {
+                number(_value);
+            } else if constexpr (std::is_same_v<typename prop::type, std::vector<handle_ref>>) {
+                for (const handle_ref& ref : _value)
+                    number(ref);
+            }
+        });
+    }
+
+    // write_properties is to write the records of the saved properties of the owner set
+    template<typename owner>
+    void write_properties(const base_object& _object)
+    {
+        for_each_saved_property<owner>(_object, [this]<typename prop>(const typename prop::type& _value) {
+            const std::uint64_t value = encode(_value);
+            const snapshot_property record{ snapshot_property_tag<prop>(),
+                                            snapshot_encoding_of<typename prop::type>(),
+                                            static_cast<std::uint32_t>(value),
+                                            static_cast<std::uint32_t>(value >> 32) };
+            std::memcpy(m_properties_out, &record, sizeof(record));
+            m_properties_out += sizeof(record);
+            ++m_next_property;
+        });
+    }
+
+    // encode is the record value of an integer property
+    template<typename value_type>
+        requires(std::is_integral_v<value_type> || std::is_enum_v<value_type>)
+    std::uint64_t encode(const value_type& _value)
+    {
+        return static_cast<std::uint64_t>(_value);
+    }
+
+    // encode is the record value of a string property, interned strings are written once and shared by the records
+    std::uint64_t encode(const interned_string& _value)
+    {
+        std::uint64_t& packed = m_string_offsets[_value.id()];
+        if (packed == k_unwritten)
+            packed = encode(_value.view());
+        return packed;
+    }
+
+    // encode is the record value of a string, its offset and size in the string section
+    std::uint64_t encode(std::string_view _value)
+    {
+        const std::uint64_t packed = static_cast<std::uint64_t>(m_next_string) << 32 | _value.size();
+        std::memcpy(m_strings_out + m_next_string, _value.data(), _value.size());
+        m_next_string += static_cast<std::uint32_t>(_value.size());
+        return packed;
+    }
+
+    // encode is the record value of a reference property
+    std::uint64_t encode(const handle_ref& _value) { return index_of(_value); }
+
+    // encode is the record value of a reference list property, its offset and size in the reference section
+    std::uint64_t encode(const std::vector<handle_ref>& _value)
+    {
+        const std::uint64_t packed = static_cast<std::uint64_t>(m_next_ref) << 32 | _value.size();
+        for (const handle_ref& ref : _value) {
+            const std::uint32_t index = index_of(ref);
+            std::memcpy(m_refs_out + m_next_ref++ * sizeof(std::uint32_t), &index, sizeof(index));
+        }
+        return packed;
+    }
+
+    // encode_handle is the record value of a handle id
+    std::uint64_t encode_handle(const underlying_type& _id)
+    {
+        if constexpr (std::is_integral_v<underlying_type>)
+            return static_cast<std::uint64_t>(_id);
+        else if constexpr (std::is_pointer_v<underlying_type>)
+            return reinterpret_cast<std::uintptr_t>(_id);
+        else if constexpr (std::is_same_v<underlying_type, std::string>)
+            return encode(_id);
+        else
+            return static_cast<std::uint64_t>(_id.Generation) << 32 | _id.Index;
+    }
+
+    // index_of is the object index of the referenced object or retired handle, k_snapshot_null_ref if it is neither
+    std::uint32_t index_of(const handle_ref& _ref) const
+    {
+        if (!_ref.valid())
+            return k_snapshot_null_ref;
+        if (_ref.serial() < m_numbers.size() && m_numbers[_ref.serial()].Generation == _ref.generation() &&
+            m_numbers[_ref.serial()].Index != k_snapshot_null_ref)
+            return m_numbers[_ref.serial()].Index;
+        auto iter = m_retired_numbers.find(retired_key(_ref));
+        return iter != m_retired_numbers.end() ? iter->second : k_snapshot_null_ref;
+    }
+
+    // retired_key is the key a retired handle is numbered under, its slot and the generation it was bound at
+    static std::uint64_t retired_key(const handle_ref& _ref)
+    {
+        return std::uint64_t{ _ref.serial() } << 32 | _ref.generation();
+    }
+
+    const handle_table* m_handles;
+    std::vector<const base_object*> m_objects;
+    std::vector<number> m_numbers;
+    std::vector<const handle<underlying_type>*> m_retired;
+    std::unordered_map<std::uint64_t, std::uint32_t> m_retired_numbers;
+    std::uint64_t m_property_count = 0;
+    std::uint64_t m_ref_count = 0;
+    std::uint64_t m_string_size = 0;
+
+    // record values of the interned strings by their id, strings repeated by many records are written once
+    static constexpr std::uint64_t k_unwritten = ~std::uint64_t{ 0 };
+    std::unordered_map<std::uintptr_t, std::uint64_t> m_string_offsets;
+
+    // write cursors into the buffer
+    char* m_objects_out = nullptr;
+    char* m_properties_out = nullptr;
+    char* m_refs_out = nullptr;
+    char* m_strings_out = nullptr;
+    std::uint32_t m_next_property = 0;
+    std::uint32_t m_next_ref = 0;
+    std::uint32_t m_next_string = 0;
+};
+
+// restore_snapshot_properties is to give the object the saved properties of the owner set, properties that weren't
+// saved are removed, _refs are the handle references of the restored objects by object index
+template<typename owner>
+void
+restore_snapshot_properties(const snapshot_object_view& _record,
+                            base_object& _object,
+                            const std::vector<handle_ref>& _refs)
+{
+    auto resolve = [&_refs](std::uint32_t _index) { return _index < _refs.size() ? _refs[_index] : handle_ref(); };
+    type_list_for_each(property_set_t<owner>{}, [&]<typename prop>() {
+        using value_type = typename prop::type;
+        constexpr snapshot_encoding encoding = snapshot_encoding_of<value_type>();
+        if constexpr (encoding != snapshot_encoding::k_none && !std::is_same_v<prop, OP_type>) {
+            if (!_record.template has<prop>()) {
+                if (_object.template has<prop>())
+                    _object.template remove<prop>();
+                return;
+            }
+            auto value = _record.template get<prop>();
+            auto& slot = _object.template get_or_create<prop>().Value;
+            if constexpr (encoding == snapshot_encoding::k_integer) {
+                slot = value;
+            } else if constexpr (encoding == snapshot_encoding::k_string) {
+                slot = _object.intern(value);
+            } else if constexpr (encoding == snapshot_encoding::k_ref) {
+                slot = resolve(value);
+            } else {
+                slot.clear();
+                slot.reserve(value.size());
+                for (std::uint32_t index : value)
+                    slot.push_back(resolve(index));
+            }
+        }
+    });
+}
+}
\ No newline at end of file
@@ -0,0 +1,554 @@
+#pragma once
+
+#include "graph/periscope_graph_fwd.h"
+#include "graph/periscope_graph_properties.h"
+#include "link/periscope_link_properties.h"
+#include "misc/periscope_class_def_properties.h"
+#include "misc/periscope_note_properties.h"
+#include "node/periscope_node_properties.h"
+#include "object/periscope_object_properties.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+class class_def;
+class node;
+class link;
+class note;
+class static_graph;
+
+// static_ref is reference to an object of a static_graph, used for link ends, subgraph members and note basis
+struct static_ref
+{
+    std::size_t Index = 0;
+};
+
+// static_value_t is the type a property of a static object is set from, strings are viewed and references name
+// objects of the same static_graph
+template<typename prop>
+using static_value_t = std::conditional_t<
+  std::is_same_v<typename prop::type, interned_string>,
+  std::string_view,
+  std::conditional_t<std::is_same_v<typename prop::type, handle_ref>,
+                     static_ref,
+                     std::conditional_t<std::is_same_v<typename prop::type, std::vector<handle_ref>>,
+                                        std::initializer_list<static_ref>,
+                                        typename prop::type>>>;
+
+// static_object is an object of type t created by a static_graph, it is set like the object a graph creates
+template<typename t>
+class static_object : public static_ref
+{
+  public:
+    constexpr static_object(static_graph& _graph, std::size_t _index)
+      : static_ref{ _index }
+      , m_graph(&_graph)
+    {
+    }
+
+    // set is to set property value with type checking
+    template<typename prop>
+    constexpr static_object& set(const static_value_t<prop>& _value);
+
+    // id is the handle id the object would have in a graph<int> built in the same order
+    constexpr std::size_t id() const { return Index; }
+
+  private:
+    static_graph* m_graph;
+};
+
+// static_graph is constexpr builder of graphs known at compile time, it renders the same text as a graph<int> whose
+// objects are created and set in the same order, so the text can be computed by static_mermaid instead of at startup
+class static_graph
+{
+  public:
+    constexpr explicit static_graph(graph_type _type = graph_type::k_flowchart)
+      : m_type(_type)
+    {
+    }
+
+    // set is to set the title of the graph
+    template<typename prop>
+    constexpr static_graph& set(std::string_view _value)
+    {
+        static_assert(std::is_same_v<prop, OP_name>, "Property not supported by static_graph");
+        m_title = _value;
+        m_titled = true;
+        return *this;
+    }
+
+    // set is to set a graph property, the ones describing how the graph is rendered are supported
+    template<template<typename> class prop>
+    constexpr static_graph& set(const typename prop<int>::type& _value)
+    {
+        if constexpr (std::is_same_v<prop<int>, GP_type<int>>) {
+            m_type = _value;
+        } else if constexpr (std::is_same_v<prop<int>, GP_sequence_show_number<int>>) {
+            m_show_number = _value;
+        } else if constexpr (std::is_same_v<prop<int>, GP_output_format<int>>) {
+            m_output_format = _value;
+        } else if constexpr (std::is_same_v<prop<int>, GP_flowchart_direction<int>>) {
+            m_direction = _value;
+            m_directed = true;
+        } else {
+            static_assert(sizeof(prop<int>) == 0, "Property not supported by static_graph");
+        }
+        return *this;
+    }
+
+    // new_object is to create an object of type t with the next handle id
+    template<typename t>
+    constexpr static_object<t> new_object()
+    {
+        static_assert(std::is_same_v<t, class_def> || std::is_same_v<t, node> || std::is_same_v<t, link> ||
+                        std::is_same_v<t, note>,
+                      "Object type not supported by static_graph");
+        static_record record;
+        if constexpr (std::is_same_v<t, class_def>)
+            record.Kind = k_class_def;
+        else if constexpr (std::is_same_v<t, node>)
+            record.Kind = k_node;
+        else if constexpr (std::is_same_v<t, link>)
+            record.Kind = k_link;
+        else
+            record.Kind = k_note;
+        m_objects.push_back(std::move(record));
+        return static_object<t>(*this, m_objects.size() - 1);
+    }
+
+    // new_link is to create a link from _source to _target like graph::new_link
+    constexpr static_object<link> new_link(const static_ref& _source,
+                                           const static_ref& _target,
+                                           std::string_view _name = {},
+                                           enum_type _style = LP_style::k_solid | LP_style::k_arrow_mask)
+    {
+        static_object<link> created = new_object<link>();
+        created.template set<LP_source>(_source).template set<LP_target>(_target).template set<LP_style>(_style);
+        if (!_name.empty())
+            created.template set<OP_name>(_name);
+        return created;
+    }
+
+    // to_string is to convert graph to string representation, identical to graph<int>::to_string
+    constexpr std::string to_string() const
+    {
+        std::string out;
+        if (m_output_format == graph_output_format::k_markdown)
+            out += "```mermaid\n";
+
+        // Title
+        if (m_titled) {
+            out += "---\ntitle: ";
+            out += m_title;
+            out += "\n---\n";
+        }
+
+        // Graph info and configuration info
+        out += m_type == graph_type::k_flowchart ? "flowchart" : "sequenceDiagram";
+        out += ' ';
+        if (m_directed && m_type == graph_type::k_flowchart)
+            out += direction_str(m_direction);
+        out += '\n';
+        if (m_show_number && m_type == graph_type::k_sequence)
+            out += "autonumber";
+        out += '\n';
+
+        for (const auto& object : m_objects) {
+            if (object.Kind == k_class_def) {
+                render_class_def(out, object);
+                out += '\n';
+            }
+        }
+        for (std::size_t i = 0; i < m_objects.size(); ++i) {
+            if (m_objects[i].Kind == k_node) {
+                render_node(out, i);
+                out += '\n';
+            }
+        }
+        for (const auto& object : m_objects) {
+            if (object.Kind == k_link || object.Kind == k_note) {
+                object.Kind == k_link ? render_link(out, object) : render_note(out, object);
+                out += '\n';
+            }
+        }
+        for (std::size_t i = 0; i < m_objects.size(); ++i) {
+            if (m_objects[i].Kind == k_node && m_objects[i].Has.ClassDef) {
+                out += "class ";
+                print_id(out, i);
+                out += ' ';
+                out += m_objects[i].ClassDef;
+                out += "Class\n";
+            }
+        }
+
+        if (m_output_format == graph_output_format::k_markdown)
+            out += "```\n";
+        return out;
+    }
+
+  private:
+    template<typename t>
+    friend class static_object;
+
+    // static_kind is the type of a static object
+    enum static_kind
+    {
+        k_class_def,
+        k_node,
+        k_link,
+        k_note,
+    };
+
+    // static_record is the properties of a static object, the ones not set are flagged in Has
+    struct static_record
+    {
+        static_kind Kind = k_node;
+        std::string Name;
+        std::string ClassDef;
+        std::string Fill;
+        std::string Stroke;
+        std::string Color;
+        enum_type Shape = NP_shape::k_rectangle;
+        enum_type Style = LP_style::k_solid | LP_style::k_arrow_mask;
+        enum_type Orient = MNP_orient::k_left;
+        bool Activate = false;
+        std::uint64_t Count = 1;
+        std::size_t Source = 0;
+        std::size_t Target = 0;
+        std::vector<std::size_t> Refs;
+        struct
+        {
+            bool Name = false;
+            bool ClassDef = false;
+            bool Fill = false;
+            bool Stroke = false;
+            bool Color = false;
+            bool Activate = false;
+            bool Source = false;
+            bool Target = false;
+            bool Refs = false;
+        } Has;
+    };
+
+    // assign is to set a property of the record
+    template<typename prop>
+    constexpr void assign(std::size_t _index, const static_value_t<prop>& _value)
+    {
+        static_record& record = m_objects[_index];
+        if constexpr (std::is_same_v<prop, OP_name>) {
+            record.Name = _value;
+            record.Has.Name = true;
+        } else if constexpr (std::is_same_v<prop, NP_shape>) {
+            record.Shape = _value;
+        } else if constexpr (std::is_same_v<prop, NP_class_def>) {
+            record.ClassDef = _value;
+            record.Has.ClassDef = true;
+        } else if constexpr (std::is_same_v<prop, NP_subgraph_node> || std::is_same_v<prop, MNP_basis>) {
+            record.Refs.clear();
+            for (const static_ref& ref : _value)
+                record.Refs.push_back(checked_ref(ref));
+            record.Has.Refs = true;
+        } else if constexpr (std::is_same_v<prop, LP_source>) {
+            record.Source = checked_ref(_value);
+            record.Has.Source = true;
+        } else if constexpr (std::is_same_v<prop, LP_target>) {
+            record.Target = checked_ref(_value);
+            record.Has.Target = true;
+        } else if constexpr (std::is_same_v<prop, LP_style>) {
+            record.Style = _value;
+        } else if constexpr (std::is_same_v<prop, LP_activate>) {
+            record.Activate = _value;
+            record.Has.Activate = true;
+        } else if constexpr (std::is_same_v<prop, LP_count>) {
+            record.Count = _value;
+        } else if constexpr (std::is_same_v<prop, MCD_fill>) {
+            record.Fill = _value;
+            record.Has.Fill = true;
+        } else if constexpr (std::is_same_v<prop, MCD_stroke>) {
+            record.Stroke = _value;
+            record.Has.Stroke = true;
+        } else if constexpr (std::is_same_v<prop, MCD_color>) {
+            record.Color = _value;
+            record.Has.Color = true;
+        } else if constexpr (std::is_same_v<prop, MNP_orient>) {
+            record.Orient = _value;
+        } else {
+            static_assert(sizeof(prop) == 0, "Property not supported by static_graph");
+        }
+    }
+
+    // checked_ref is the index of the referenced object, which must belong to this graph
+    constexpr std::size_t checked_ref(const static_ref& _ref) const
+    {
+        if (_ref.Index >= m_objects.size())
+            throw std::runtime_error("Referenced object not found");
+        return _ref.Index;
+    }
+
+    // direction_str is the text of GP_flowchart_direction
+    static constexpr std::string_view direction_str(enum_type _direction)
+    {
+        switch (_direction) {
+            case GP_flowchart_direction<int>::k_top_to_down:
+                return "TD";
+            case GP_flowchart_direction<int>::k_down_to_top:
+                return "BT";
+            case GP_flowchart_direction<int>::k_left_to_right:
+                return "LR";
+            case GP_flowchart_direction<int>::k_right_to_left:
+                return "RL";
+            default:
+                throw std::runtime_error("Unsupported flowchart direction");
+        }
+    }
+
+    // style_str is the text of LP_style for the graph type
+    constexpr std::string_view style_str(enum_type _style) const
+    {
+        const bool arrow = _style & LP_style::k_arrow_mask;
+        if (m_type == graph_type::k_flowchart) {
+            switch (_style & ~LP_style::k_arrow_mask) {
+                case LP_style::k_solid:
+                    return arrow ? "-->" : "--";
+                case LP_style::k_dashed:
+                    return arrow ? "-.->" : "-.-";
+                case LP_style::k_bold_solid:
+                    return "==>";
+                default:
+                    throw std::runtime_error("Unsupported style");
+            }
+        }
+        switch (_style & ~LP_style::k_arrow_mask) {
+            case LP_style::k_solid:
+                return arrow ? "->>" : "->";
+            case LP_style::k_dashed:
+                return arrow ? "-->>" : "-->";
+            default:
+                return "";
+        }
+    }
+
+    // print_number is to append the decimal digits of the value
+    static constexpr void print_number(std::string& _out, std::uint64_t _value)
+    {
+        char digits[20] = {};
+        std::size_t size = 0;
+        do {
+            digits[size++] = static_cast<char>('0' + _value % 10);
+            _value /= 10;
+        } while (_value != 0);
+        while (size > 0)
+            _out += digits[--size];
+    }
+
+    // print_id is to append the handle id of the object as a graph<int> prints it
+    constexpr void print_id(std::string& _out, std::size_t _index) const
+    {
+        if (m_type == graph_type::k_sequence)
+            _out += "OBJ";
+        print_number(_out, _index);
+    }
+
+    // name_of is the name of the object, which must be set
+    static constexpr const std::string& name_of(const static_record& _record)
+    {
+        if (!_record.Has.Name)
+            throw std::runtime_error("Property not found");
+        return _record.Name;
+    }
+
+    // render_class_def is the text of class_def::render_to_impl
+    constexpr void render_class_def(std::string& _out, const static_record& _record) const
+    {
+        if (m_type != graph_type::k_flowchart)
+            return;
+        if (!_record.Has.Name)
+            throw std::runtime_error("class_def: name is required");
+        _out += "classDef ";
+        _out += _record.Name;
+        _out += "Class ";
+        std::string_view separator;
+        auto append = [&_out, &separator](bool _has, std::string_view _key, std::string_view _value) {
+            if (!_has)
+                return;
+            _out += separator;
+            _out += _key;
+            _out += _value;
+            separator = ",";
+        };
+        append(_record.Has.Fill, "fill:", _record.Fill);
+        append(_record.Has.Stroke, "stroke:", _record.Stroke);
+        append(_record.Has.Color, "color:", _record.Color);
+    }
+
+    // render_node is the text of node::render_to_impl
+    constexpr void render_node(std::string& _out, std::size_t _index) const
+    {
+        const static_record& record = m_objects[_index];
+        if (m_type == graph_type::k_sequence) {
+            _out += "participant ";
+            print_id(_out, _index);
+            _out += " as ";
+            _out += name_of(record);
+            return;
+        }
+        if (record.Has.Refs) {
+            _out += "subgraph ";
+            print_id(_out, _index);
+            _out += "[\"";
+            _out += record.Name;
+            _out += "\"]\n";
+            for (std::size_t ref : record.Refs) {
+                print_id(_out, ref);
+                _out += '\n';
+            }
+            _out += "end\n";
+            return;
+        }
+        print_id(_out, _index);
+        _out += "@{ shape: ";
+        switch (record.Shape) {
+            case NP_shape::k_rectangle:
+                _out += "rect";
+                break;
+            case NP_shape::k_diamond:
+                _out += "diamond";
+                break;
+            case NP_shape::k_parallelogram:
+                _out += "parallelogram";
+                break;
+            default:
+                throw std::runtime_error("Unsupported shape");
+        }
+        _out += ", label: ";
+        _out += name_of(record);
+        _out += " }";
+    }
+
+    // render_link is the text of link::render_to_impl
+    constexpr void render_link(std::string& _out, const static_record& _record) const
+    {
+        if (!_record.Has.Source || !_record.Has.Target)
+            throw std::runtime_error("Property not found");
+        const std::string_view arrow = style_str(_record.Style);
+        print_id(_out, _record.Source);
+        _out += ' ';
+        if (m_type == graph_type::k_flowchart) {
+            if (_record.Has.Name || _record.Count > 1) {
+                _out += arrow.substr(0, 2);
+                _out += '"';
+                _out += _record.Name;
+                render_count(_out, _record);
+                _out += '"';
+                _out += arrow.substr(arrow.size() - 3, 3);
+            } else {
+                _out += arrow;
+            }
+            _out += ' ';
+            print_id(_out, _record.Target);
+            return;
+        }
+        _out += arrow;
+        if (_record.Has.Activate)
+            _out += _record.Activate ? '+' : '-';
+        _out += ' ';
+        print_id(_out, _record.Target);
+        _out += " : ";
+        _out += _record.Name;
+        render_count(_out, _record);
+    }
+
+    // render_count is the text of link::count_suffix
+    static constexpr void render_count(std::string& _out, const static_record& _record)
+    {
+        if (_record.Count <= 1)
+            return;
+        _out += _record.Has.Name ? " (x" : "x";
+        print_number(_out, _record.Count);
+        if (_record.Has.Name)
+            _out += ')';
+    }
+
+    // render_note is the text of note::render_to_impl
+    constexpr void render_note(std::string& _out, const static_record& _record) const
+    {
+        if (!_record.Has.Refs || m_type != graph_type::k_sequence)
+            return;
+        if (_record.Refs.size() != 1) {
+            _out += "Note over ";
+        } else {
+            _out += "Note ";
+            _out += _record.Orient == MNP_orient::k_left ? "left" : "right";
+            _out += " of ";
+        }
+        for (std::size_t i = 0; i < _record.Refs.size(); ++i) {
+            if (i != 0)
+                _out += ", ";
+            print_id(_out, _record.Refs[i]);
+        }
+        _out += " : ";
+        _out += _record.Name;
+    }
+
+    graph_type m_type;
+    graph_output_format m_output_format = graph_output_format::k_markdown;
+    enum_type m_direction = 0;
+    bool m_directed = false;
+    bool m_show_number = false;
+    std::string m_title;
+    bool m_titled = false;
+    std::vector<static_record> m_objects;
+};
+
+// static_object::set is to set property value with type checking
+template<typename t>
+template<typename prop>
+constexpr static_object<t>&
+static_object<t>::set(const static_value_t<prop>& _value)
+{
+    static_assert(std::is_base_of_v<typename prop::owner_type, t>,
+                  "Owner must be a derived class of prop::owner_type");
+    m_graph->template assign<prop>(Index, _value);
+    return *this;
+}
+
+// static_text is text of a fixed size computed at compile time, null terminated
+template<std::size_t size>
+struct static_text
+{
+    char Data[size + 1] = {};
+
+    // view is the text without the terminator
+    constexpr std::string_view view() const { return std::string_view(Data, size); }
+
+    // c_str is the null terminated text
+    constexpr const char* c_str() const { return Data; }
+
+    constexpr operator std::string_view() const { return view(); }
+};
+
+// render_static is the text of the static_graph returned by builder, rendered at compile time
+template<auto builder>
+consteval auto
+render_static()
+{
+    constexpr std::size_t size = builder().to_string().size();
+    static_text<size> text;
+    const std::string rendered = builder().to_string();
+    std::copy(rendered.begin(), rendered.end(), text.Data);
+    return text;
+}
+
+// static_mermaid is the text of the static_graph returned by builder, so it costs nothing at runtime
+template<auto builder>
+inline constexpr auto static_mermaid = render_static<builder>();
+}
\ No newline at end of file
@@ -3,7 +3,10 @@
 #include "link/periscope_link_properties.h"
 #include "object/periscope_object.h"
 #include "object/periscope_object_properties.h"
+#include <cstdint>
 #include <format>
+#include <string>
+#include <string_view>
 
 namespace periscope {
 // ------------------------ Main template -----------------------
@@ -15,30 +18,56 @@ class link : public object<link>
     link() { set<OP_printable>(true); }
 
   public:
-    // to_string_impl is implementation of object::to_string_impl
-    std::string to_string_impl(graph_type _graph_type = io().GraphType) const
+    // render_to_impl is implementation of object::render_to_impl
+    template<typename output_iterator>
+    output_iterator render_to_impl(output_iterator _out, const render_context& _context = {}) const
     {
-        std::string arrow_str = _V_str<LP_style>();
-        switch (_graph_type) {
+        std::string arrow_str = _V_str<LP_style>(_context);
+        switch (_context.GraphType) {
             case graph_type::k_flowchart: {
-                if (has<OP_name>()) {
-                    std::string pre = arrow_str.substr(0, 2);
-                    arrow_str = pre + "\"" + _V_str<OP_name>() + "\"" + arrow_str.substr((int)arrow_str.size() - 3, 3);
+                if (has<OP_name>() || count() > 1) {
+                    std::string_view arrow = arrow_str;
+                    return std::format_to(_out,
+                                          "{} {}\"{}{}\"{} {}",
+                                          print_ref(get<LP_source>().Value, _context),
+                                          arrow.substr(0, 2),
+                                          _V_view<OP_name>(),
+                                          count_suffix(),
+                                          arrow.substr(arrow.size() - 3, 3),
+                                          print_ref(get<LP_target>().Value, _context));
                 }
-                return std::format(
-                  "{} {} {}", get<LP_source>().Value->print(), arrow_str, get<LP_target>().Value->print());
+                return std::format_to(_out,
+                                      "{} {} {}",
+                                      print_ref(get<LP_source>().Value, _context),
+                                      arrow_str,
+                                      print_ref(get<LP_target>().Value, _context));
             }
             case graph_type::k_sequence: {
-                arrow_str += _V_str<LP_activate>();
-                return std::format("{} {} {} : {}",
-                                   get<LP_source>().Value->print(),
-                                   arrow_str,
-                                   get<LP_target>().Value->print(),
-                                   _V_str<OP_name>());
+                return std::format_to(_out,
+                                      "{} {}{} {} : {}{}",
+                                      print_ref(get<LP_source>().Value, _context),
+                                      arrow_str,
+                                      _V_str<LP_activate>(_context),
+                                      print_ref(get<LP_target>().Value, _context),
+                                      _V_view<OP_name>(),
+                                      count_suffix());
             }
             default:
                 throw std::runtime_error("Unsupported graph type for link");
         }
     }
+
+    // count is the number of identical links aggregated into this one
+    std::uint64_t count() const { return has<LP_count>() ? get<LP_count>().Value : 1; }
+
+  private:
+    // count_suffix is the count appended to the name when identical links were aggregated into this one
+    std::string count_suffix() const
+    {
+        const std::uint64_t hits = count();
+        if (hits <= 1)
+            return {};
+        return has<OP_name>() ? std::format(" (x{})", hits) : std::format("x{}", hits);
+    }
 };
 }
\ No newline at end of file
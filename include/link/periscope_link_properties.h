@@ -2,6 +2,7 @@
 
 #include "object/periscope_handle.h"
 #include "object/periscope_object_properties.h"
+#include <cstdint>
 
 namespace periscope {
 // ------------------------ Main template -----------------------
@@ -9,13 +10,13 @@ namespace periscope {
 class link;
 
 // LP_source is property for link source handle
-struct LP_source : public base_property<std::shared_ptr<base_handle>, link>
+struct LP_source : public base_property<handle_ref, link>
 {
     using owner_type = link;
 };
 
 // LP_target is property for link target handle
-struct LP_target : public base_property<std::shared_ptr<base_handle>, link>
+struct LP_target : public base_property<handle_ref, link>
 {
     using owner_type = link;
 };
@@ -34,9 +35,9 @@ struct LP_style : public base_property<enum_type, link>
     };
 
     // to_string is to convert property to string representation
-    static std::string to_string(const LP_style& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const LP_style& _property, const render_context& _context = {})
     {
-        if (_graph_type == graph_type::k_flowchart) {
+        if (_context.GraphType == graph_type::k_flowchart) {
             switch (_property.Value & ~style::k_arrow_mask) {
                 case style::k_solid:
                     return std::string("--") + (_property.Value & style::k_arrow_mask ? ">" : "");
@@ -47,7 +48,7 @@ struct LP_style : public base_property<enum_type, link>
                 default:
                     throw std::runtime_error("Unsupported style");
             }
-        } else if (_graph_type == graph_type::k_sequence) {
+        } else if (_context.GraphType == graph_type::k_sequence) {
             switch (_property.Value & ~style::k_arrow_mask) {
                 case style::k_solid:
                     return std::string("->") + (_property.Value & style::k_arrow_mask ? ">" : "");
@@ -60,22 +61,33 @@ struct LP_style : public base_property<enum_type, link>
     }
 
     // to_string_default is to get default string representation
-    static std::string to_string_default(graph_type _graph_type = io().GraphType)
+    static std::string to_string_default(const render_context& _context = {})
     {
         static LP_style style{ style::k_solid | style::k_arrow_mask };
-        return to_string(style, _graph_type);
+        return to_string(style, _context);
     }
 };
 
 struct LP_activate : public base_property<bool, link>
 {
     // to_string is to convert property to string representation
-    static std::string to_string(const LP_activate& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const LP_activate& _property, const render_context& _context = {})
     {
         return _property.Value ? "+" : "-";
     }
 
     // to_string_default is to get default string representation
-    static std::string to_string_default(graph_type _graph_type = io().GraphType) { return ""; }
+    static std::string to_string_default(const render_context& _context = {}) { return ""; }
+};
+
+// LP_count is property for the number of identical links aggregated into this one
+struct LP_count : public base_property<std::uint64_t, link>
+{};
+
+// property_set is specialization for link properties
+template<>
+struct property_set<link>
+{
+    using type = type_list<LP_source, LP_target, LP_style, LP_activate, LP_count>;
 };
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "misc/periscope_class_def_properties.h"
 #include "object/periscope_object.h"
+#include <format>
 
 namespace periscope {
 
@@ -11,20 +12,29 @@ class class_def : public object<class_def>
   public:
     class_def() { set<OP_printable>(true); }
 
-    // to_string_impl is implementation of object::to_string_impl
-    std::string to_string_impl(graph_type _graph_type = io().GraphType) const
+    // render_to_impl is implementation of object::render_to_impl
+    template<typename output_iterator>
+    output_iterator render_to_impl(output_iterator _out, const render_context& _context = {}) const
     {
-        if (_graph_type == graph_type::k_flowchart) {
+        if (_context.GraphType == graph_type::k_flowchart) {
             if (!has<OP_name>()) {
                 throw std::runtime_error("class_def: name is required");
             }
-            std::string props = _V_str<MCD_fill>() + _V_str<MCD_stroke>() + _V_str<MCD_color>();
-            if (props.back() == ',') {
-                props.pop_back();
+            _out = std::format_to(_out, "classDef {}Class ", get<OP_name>().Value.view());
+            const char* separator = "";
+            if (has<MCD_fill>()) {
+                _out = std::format_to(_out, "{}fill:{}", separator, get<MCD_fill>().Value.view());
+                separator = ",";
+            }
+            if (has<MCD_stroke>()) {
+                _out = std::format_to(_out, "{}stroke:{}", separator, get<MCD_stroke>().Value.view());
+                separator = ",";
+            }
+            if (has<MCD_color>()) {
+                _out = std::format_to(_out, "{}color:{}", separator, get<MCD_color>().Value.view());
             }
-            return "classDef " + _V_str<OP_name>() + "Class" + " " + props;
         }
-        return "";
+        return _out;
     }
 };
 
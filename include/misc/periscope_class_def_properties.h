@@ -7,32 +7,39 @@ namespace periscope {
 class class_def;
 
 // MCD_fill is the fill color of the class
-struct MCD_fill : public base_property<std::string, class_def>
+struct MCD_fill : public base_property<interned_string, class_def>
 {
     // to_string is to convert property to string representation
-    static std::string to_string(const MCD_fill& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const MCD_fill& _property, const render_context& _context = {})
     {
-        return "fill:" + _property.Value + ",";
+        return "fill:" + std::string(_property.Value.view()) + ",";
     }
 };
 
 // MCD_stroke is the stroke color of the class
-struct MCD_stroke : public base_property<std::string, class_def>
+struct MCD_stroke : public base_property<interned_string, class_def>
 {
     // to_string is to convert property to string representation
-    static std::string to_string(const MCD_stroke& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const MCD_stroke& _property, const render_context& _context = {})
     {
-        return "stroke:" + _property.Value + ",";
+        return "stroke:" + std::string(_property.Value.view()) + ",";
     }
 };
 
 // MCD_color is the color of the class
-struct MCD_color : public base_property<std::string, class_def>
+struct MCD_color : public base_property<interned_string, class_def>
 {
     // to_string is to convert property to string representation
-    static std::string to_string(const MCD_color& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const MCD_color& _property, const render_context& _context = {})
     {
-        return "color:" + _property.Value + ",";
+        return "color:" + std::string(_property.Value.view()) + ",";
     }
 };
+
+// property_set is specialization for class definition properties
+template<>
+struct property_set<class_def>
+{
+    using type = type_list<MCD_fill, MCD_stroke, MCD_color>;
+};
 }
\ No newline at end of file
@@ -13,22 +13,29 @@ class note : public object<note>
     note() { set<OP_printable>(true); }
 
   public:
-    // to_string_impl is implementation of object::to_string_impl
-    std::string to_string_impl(graph_type _graph_type = io().GraphType) const
+    // render_to_impl is implementation of object::render_to_impl
+    template<typename output_iterator>
+    output_iterator render_to_impl(output_iterator _out, const render_context& _context = {}) const
     {
         if (!has<MNP_basis>())
-            return "";
+            return _out;
 
         auto& basis = get<MNP_basis>().Value;
-        if (_graph_type == graph_type::k_sequence) {
+        if (_context.GraphType == graph_type::k_sequence) {
             if (basis.size() != 1) {
-                return std::format("Note over {} : {}", _V_str<MNP_basis>(), _V_str<OP_name>());
+                _out = std::format_to(_out, "Note over ");
             } else {
-                return std::format("Note {} of {} : {}", _V_str<MNP_orient>(), _V_str<MNP_basis>(), _V_str<OP_name>());
+                _out = std::format_to(_out, "Note {} of ", _V_str<MNP_orient>(_context));
             }
+            for (std::size_t i = 0; i < basis.size(); ++i) {
+                if (i != 0)
+                    _out = std::format_to(_out, ", ");
+                _out = std::format_to(_out, "{}", print_ref(basis[i], _context));
+            }
+            return std::format_to(_out, " : {}", _V_view<OP_name>());
         }
 
-        return "";
+        return _out;
     }
 };
 } // namespace periscope
\ No newline at end of file
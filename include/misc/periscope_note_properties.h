@@ -2,6 +2,7 @@
 
 #include "object/periscope_handle.h"
 #include "object/periscope_object_properties.h"
+#include <vector>
 
 namespace periscope {
 // note is a class for notes
@@ -16,36 +17,30 @@ struct MNP_orient : public base_property<enum_type, note>
     };
 
     // to_string is to convert property to string representation
-    static std::string to_string(const MNP_orient& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const MNP_orient& _property, const render_context& _context = {})
     {
-        if (_graph_type == graph_type::k_sequence) {
+        if (_context.GraphType == graph_type::k_sequence) {
             return _property.Value == orient::k_left ? "left" : "right";
         }
         return "";
     }
 
     // to_string_default is to get default string representation
-    static std::string to_string_default(graph_type _graph_type = io().GraphType)
+    static std::string to_string_default(const render_context& _context = {})
     {
         static MNP_orient orient{ orient::k_left };
-        return to_string(orient, _graph_type);
+        return to_string(orient, _context);
     }
 };
 
-struct MNP_basis : public base_property<std::vector<std::shared_ptr<base_handle>>, note>
+// MNP_basis is property for the participants a note is attached to
+struct MNP_basis : public base_property<std::vector<handle_ref>, note>
+{};
+
+// property_set is specialization for note properties
+template<>
+struct property_set<note>
 {
-    // to_string is to convert property to string representation
-    static std::string to_string(const MNP_basis& _property, graph_type _graph_type = io().GraphType)
-    {
-        std::string str = "";
-        if (_graph_type == graph_type::k_sequence) {
-            for (const auto& handle : _property.Value) {
-                str += handle->print();
-                str += ", ";
-            }
-            str.erase(str.size() - 2, str.size());
-        }
-        return str;
-    }
+    using type = type_list<MNP_orient, MNP_basis>;
 };
 } // namespace periscope
\ No newline at end of file
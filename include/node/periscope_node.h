@@ -15,33 +15,29 @@ class node : public object<node>
     node() { set<OP_printable>(true); }
 
   public:
-    // to_string_impl is implementation of object::to_string_impl
-    std::string to_string_impl(graph_type _graph_type = io().GraphType) const
+    // render_to_impl is implementation of object::render_to_impl
+    template<typename output_iterator>
+    output_iterator render_to_impl(output_iterator _out, const render_context& _context = {}) const
     {
-        switch (_graph_type) {
+        switch (_context.GraphType) {
             case graph_type::k_flowchart: {
                 if (has<NP_subgraph_node>()) {
-                    std::string subgraph_str = "subgraph ";
-                    subgraph_str += get_handle()->print();
-                    subgraph_str += std::format("[\"{}\"]", _V_str<OP_name>());
-                    subgraph_str += "\n";
+                    _out = std::format_to(
+                      _out, "subgraph {}[\"{}\"]\n", get_handle()->print(_context), _V_view<OP_name>());
                     for (const auto& handle : get<NP_subgraph_node>().Value) {
-                        subgraph_str += handle->print();
-                        subgraph_str += "\n";
+                        _out = std::format_to(_out, "{}\n", print_ref(handle, _context));
                     }
-                    subgraph_str += "end\n";
-                    return subgraph_str;
-                } else {
-                    std::string handle_str = get_handle()->print();
-                    std::string shape_str = _V_str<NP_shape>();
-                    std::string label_str = get<OP_name>().Value;
-                    return std::format("{}@{{ shape: {}, label: {} }}", handle_str, shape_str, label_str);
+                    return std::format_to(_out, "end\n");
                 }
+                return std::format_to(_out,
+                                      "{}@{{ shape: {}, label: {} }}",
+                                      get_handle()->print(_context),
+                                      _V_str<NP_shape>(_context),
+                                      get<OP_name>().Value.view());
             }
             case graph_type::k_sequence: {
-                std::string handle_str = get_handle()->print();
-                std::string label_str = get<OP_name>().Value;
-                return std::format("participant {} as {}", handle_str, label_str);
+                return std::format_to(
+                  _out, "participant {} as {}", get_handle()->print(_context), get<OP_name>().Value.view());
             }
             default:
                 throw std::runtime_error("Unsupported graph type");
@@ -21,9 +21,9 @@ struct NP_shape : base_property<enum_type, node>
     };
 
     // to_string is to convert property to string representation
-    static std::string to_string(const NP_shape& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const NP_shape& _property, const render_context& _context = {})
     {
-        if (_graph_type != graph_type::k_flowchart)
+        if (_context.GraphType != graph_type::k_flowchart)
             return "";
         switch (_property.Value) {
             case shape::k_rectangle:
@@ -38,24 +38,31 @@ struct NP_shape : base_property<enum_type, node>
     }
 
     // to_string_default is to get default string representation
-    static std::string to_string_default(graph_type _graph_type = io().GraphType)
+    static std::string to_string_default(const render_context& _context = {})
     {
         static NP_shape shp{ shape::k_rectangle };
-        return to_string(shp, _graph_type);
+        return to_string(shp, _context);
     }
 };
 
 // NP_subgraph is property for node subgraph
-struct NP_subgraph_node : base_property<std::vector<std::shared_ptr<base_handle>>, node>
+struct NP_subgraph_node : base_property<std::vector<handle_ref>, node>
 {};
 
 // NP_class_def is property for node class definition
-struct NP_class_def : base_property<std::string, node>
+struct NP_class_def : base_property<interned_string, node>
 {
     // to_string is to convert property to string representation
-    static std::string to_string(const NP_class_def& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const NP_class_def& _property, const render_context& _context = {})
     {
-        return _property.Value;
+        return std::string(_property.Value.view());
     }
 };
+
+// property_set is specialization for node properties
+template<>
+struct property_set<node>
+{
+    using type = type_list<NP_shape, NP_subgraph_node, NP_class_def>;
+};
 } // namespace periscope
\ No newline at end of file
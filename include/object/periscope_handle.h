@@ -1,10 +1,15 @@
 #pragma once
 
 #include "graph/periscope_graph_fwd.h"
-#include <set>
-#include <sstream>
+#include <cstdint>
+#include <format>
+#include <memory>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace periscope {
 // ------------------------ Main template -----------------------
@@ -12,12 +17,171 @@ namespace periscope {
 template<typename underlying_type>
 class graph;
 
+class base_handle;
+class handle_table;
+
+// handle_ref is compact, trivially copyable reference to the handle of an object inside its graph
+class handle_ref
+{
+  public:
+    handle_ref() = default;
+
+    // handle_ref is to refer to a handle bound by a graph
+    handle_ref(const std::shared_ptr<base_handle>& _handle);
+
+    // serial is the slot of the handle in the handle table of the graph
+    std::uint32_t serial() const { return m_serial; }
+
+    // generation is the generation of the slot the reference was taken at
+    std::uint32_t generation() const { return m_generation; }
+
+    // valid is whether the reference was taken from a bound handle
+    bool valid() const { return m_serial != k_invalid_serial; }
+
+    // operator== is equality comparison for handle references
+    friend bool operator==(const handle_ref& _lhs, const handle_ref& _rhs) = default;
+
+  private:
+    friend class handle_table;
+
+    handle_ref(std::uint32_t _serial, std::uint32_t _generation)
+      : m_serial(_serial)
+      , m_generation(_generation)
+    {
+    }
+
+    static constexpr std::uint32_t k_invalid_serial = ~std::uint32_t{ 0 };
+
+    std::uint32_t m_serial = k_invalid_serial;
+    std::uint32_t m_generation = 0;
+};
+
 // base_handle is base class for all handles
 class base_handle
 {
   public:
     // print is interface to convert handle to string representation
-    virtual std::string print(graph_type _graph_type = io().GraphType) const = 0;
+    virtual std::string print(const render_context& _context = {}) const = 0;
+
+    // ref is the reference to this handle inside its graph, invalid if the handle is not bound
+    handle_ref ref() const { return m_ref; }
+
+  private:
+    friend class handle_table;
+
+    handle_ref m_ref;
+};
+
+inline handle_ref::handle_ref(const std::shared_ptr<base_handle>& _handle)
+  : handle_ref(_handle ? _handle->ref() : handle_ref())
+{
+}
+
+// handle_table is graph-local table resolving handle references, slots of unbound handles are reused
+class handle_table
+{
+  public:
+    // bind is to assign a slot to the handle
+    handle_ref bind(base_handle& _handle)
+    {
+        std::uint32_t serial;
+        if (!m_free_serials.empty()) {
+            serial = m_free_serials.back();
+            m_free_serials.pop_back();
+        } else {
+            serial = static_cast<std::uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+        }
+        auto& entry = m_entries[serial];
+        entry.Handle = &_handle;
+        _handle.m_ref = handle_ref(serial, entry.Generation);
+        return _handle.m_ref;
+    }
+
+    // unbind is to release the slot of the handle, references to it become stale
+    void unbind(const base_handle& _handle)
+    {
+        const handle_ref ref = _handle.ref();
+        if (find(ref) != &_handle)
+            return;
+        auto& entry = m_entries[ref.serial()];
+        entry.Handle = nullptr;
+        ++entry.Generation;
+        m_free_serials.push_back(ref.serial());
+    }
+
+    // retire is to unbind the handle but keep it printable for the references left to it, so links and notes to a
+    // deleted node render as they did before it was deleted
+    void retire(std::shared_ptr<const base_handle> _handle)
+    {
+        const handle_ref ref = _handle->ref();
+        if (find(ref) != _handle.get())
+            return;
+        unbind(*_handle);
+        m_retired.insert_or_assign(retired_key(ref), std::move(_handle));
+    }
+
+    // find_retired is to resolve a stale reference to a retired handle, nullptr if it wasn't retired
+    const base_handle* find_retired(const handle_ref& _ref) const
+    {
+        auto iter = m_retired.find(retired_key(_ref));
+        return iter != m_retired.end() ? iter->second.get() : nullptr;
+    }
+
+    // retired_count is the number of retired handles kept printable
+    std::size_t retired_count() const { return m_retired.size(); }
+
+    // prune_retired is to drop the retired handles none of the references still point to
+    void prune_retired(const std::vector<handle_ref>& _referenced)
+    {
+        decltype(m_retired) kept;
+        for (const handle_ref& ref : _referenced) {
+            auto iter = m_retired.find(retired_key(ref));
+            if (iter != m_retired.end())
+                kept.insert(*iter);
+        }
+        m_retired = std::move(kept);
+    }
+
+    // reserve is to make room for _count more bound handles
+    void reserve(std::size_t _count) { m_entries.reserve(m_entries.size() + _count); }
+
+    // find is to resolve the reference, nullptr if it is stale or unknown
+    const base_handle* find(const handle_ref& _ref) const
+    {
+        if (!_ref.valid() || _ref.serial() >= m_entries.size())
+            return nullptr;
+        const auto& entry = m_entries[_ref.serial()];
+        return entry.Generation == _ref.generation() ? entry.Handle : nullptr;
+    }
+
+  private:
+    // entry is a slot of the table
+    struct entry
+    {
+        const base_handle* Handle = nullptr;
+        std::uint32_t Generation = 0;
+    };
+
+    // retired_key is the key a retired handle is kept under, its slot and the generation it was bound at
+    static std::uint64_t retired_key(const handle_ref& _ref)
+    {
+        return std::uint64_t{ _ref.serial() } << 32 | _ref.generation();
+    }
+
+    std::vector<entry> m_entries;
+    std::vector<std::uint32_t> m_free_serials;
+    std::unordered_map<std::uint64_t, std::shared_ptr<const base_handle>> m_retired;
+};
+
+// slot_id is generational slot map id, graphs using it as handle type reuse deleted slots under a new generation
+struct slot_id
+{
+    std::uint32_t Index = 0;
+    std::uint32_t Generation = 0;
+
+    // operator<=> is comparison for slot ids
+    friend auto operator<=>(const slot_id& _lhs, const slot_id& _rhs) = default;
 };
 
 // handle is typed handle with underlying type
@@ -36,20 +200,21 @@ class handle : public base_handle
     id_type id() const { return m_id; }
 
     // print is implementation of base_handle::print
-    std::string print(graph_type _graph_type = io().GraphType) const override
+    std::string print(const render_context& _context = {}) const override
     {
         if constexpr (std::is_same_v<id_type, std::string>) {
             return m_id;
         } else if constexpr (std::is_integral_v<id_type>) {
-            if (_graph_type == graph_type::k_sequence) {
+            if (_context.GraphType == graph_type::k_sequence) {
                 return "OBJ" + std::to_string(m_id);
             } else {
                 return std::to_string(m_id);
             }
         } else if constexpr (std::is_pointer_v<id_type>) {
-            std::ostringstream oss;
-            oss << "0x" << std::hex << reinterpret_cast<uintptr_t>(m_id);
-            return oss.str();
+            return std::format("0x{:x}", reinterpret_cast<std::uintptr_t>(m_id));
+        } else if constexpr (std::is_same_v<id_type, slot_id>) {
+            return std::format(
+              "{}{}_{}", _context.GraphType == graph_type::k_sequence ? "OBJ" : "S", m_id.Index, m_id.Generation);
         } else {
             return std::to_string(m_id);
         }
@@ -96,45 +261,73 @@ template<typename underlying_type, typename = void>
 class handle_allocator
 {
   public:
-    // allocate is to allocate a new handle
-    static handle<void*> allocate()
+    // allocate is to make the handle for the serial reserved by the handle manager
+    static handle<void*> allocate(std::uint64_t _serial)
     {
-        static unsigned int next_id = 0;
-        return handle<void*>(reinterpret_cast<void*>(next_id++));
+        return handle<void*>(reinterpret_cast<void*>(static_cast<std::uintptr_t>(_serial)));
     }
 };
 
-// handle_manager is manager for handle allocation and deallocation
+// handle_manager is manager for handle allocation and deallocation, every manager numbers its handles on its own,
+// like the graph owning it, it is not safe to use from several threads at once
 template<typename underlying_type>
 class handle_manager
 {
   public:
-    // allocate is to allocate a unique handle
+    // allocate is to allocate a unique handle, skipping the ones chosen with allocate_at
     handle<underlying_type> allocate()
     {
         while (true) {
-            auto _handle = handle_allocator<underlying_type>::allocate();
-            if (m_handles.find(_handle) == m_handles.end()) {
-                m_handles.insert(_handle);
+            auto _handle = handle_allocator<underlying_type>::allocate(m_next_serial++);
+            if (m_handles.insert(_handle.id()).second)
                 return _handle;
-            }
         }
     }
 
+    // handle_block is a range of consecutive serials reserved by allocate_block
+    struct handle_block
+    {
+        std::uint64_t Next = 0;
+        std::uint64_t End = 0;
+    };
+
+    // allocate_block is to reserve _count consecutive serials, for creating many objects at once
+    handle_block allocate_block(std::size_t _count)
+    {
+        const std::uint64_t first = m_next_serial;
+        m_next_serial += _count;
+        return handle_block{ first, m_next_serial };
+    }
+
+    // allocate is to allocate a unique handle from the serials of the block, or like allocate() once it is used up
+    handle<underlying_type> allocate(handle_block& _block)
+    {
+        while (_block.Next != _block.End) {
+            auto _handle = handle_allocator<underlying_type>::allocate(_block.Next++);
+            if (m_handles.insert(_handle.id()).second)
+                return _handle;
+        }
+        return allocate();
+    }
+
+    // reserve is to make room for _count more handles
+    void reserve(std::size_t _count) { m_handles.reserve(m_handles.size() + _count); }
+
     // deallocate is to deallocate a handle
-    void deallocate(const handle<underlying_type>& _handle) { m_handles.erase(_handle); }
+    void deallocate(const handle<underlying_type>& _handle) { m_handles.erase(_handle.id()); }
 
     // is_allocated is to check if handle is allocated
     bool is_allocated(const handle<underlying_type>& _handle) const
     {
-        return m_handles.find(_handle) != m_handles.end();
+        return m_handles.contains(_handle.id());
     }
 
     // allocate_at is to allocate a handle at specific value
-    bool allocate_at(const handle<underlying_type>& _handle) { return m_handles.insert(_handle).second; }
+    bool allocate_at(const handle<underlying_type>& _handle) { return m_handles.insert(_handle.id()).second; }
 
   protected:
-    std::set<handle<underlying_type>> m_handles;
+    std::uint64_t m_next_serial = 0;
+    std::unordered_set<underlying_type> m_handles;
 };
 
 // ------------------------ Specializations -----------------------
@@ -143,11 +336,10 @@ template<typename underlying_type>
 class handle_allocator<underlying_type, std::enable_if_t<std::is_integral_v<underlying_type>>>
 {
   public:
-    // allocate is to allocate a handle with integral type
-    static handle<underlying_type> allocate()
+    // allocate is to make the handle with integral type for the serial
+    static handle<underlying_type> allocate(std::uint64_t _serial)
     {
-        static underlying_type next_id = 0;
-        return handle<underlying_type>(next_id++);
+        return handle<underlying_type>(static_cast<underlying_type>(_serial));
     }
 };
 
@@ -156,11 +348,10 @@ template<>
 class handle_allocator<std::string>
 {
   public:
-    // allocate is to allocate a handle with string type
-    static handle<std::string> allocate()
+    // allocate is to make the handle with string type for the serial
+    static handle<std::string> allocate(std::uint64_t _serial)
     {
-        static unsigned int next_id = 0;
-        return handle<std::string>("handle_" + std::to_string(next_id++));
+        return handle<std::string>("handle_" + std::to_string(_serial));
     }
 };
 
@@ -169,12 +360,118 @@ template<>
 class handle_allocator<const void*>
 {
   public:
-    // allocate is to allocate a handle with const void* type
-    static handle<const void*> allocate()
+    // allocate is to make the handle with const void* type for the serial
+    static handle<const void*> allocate(std::uint64_t _serial)
     {
-        static unsigned int next_id = 0;
-        return handle<const void*>(reinterpret_cast<const void*>(next_id++));
+        return handle<const void*>(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(_serial)));
     }
 };
 
+// handle_manager is specialization for slot ids, deleted slots are reused with the next generation
+template<>
+class handle_manager<slot_id>
+{
+  public:
+    // allocate is to take a free slot, or append one
+    handle<slot_id> allocate()
+    {
+        std::uint32_t index;
+        if (!m_free_slots.empty()) {
+            index = m_free_slots.back();
+            take_free(index);
+        } else {
+            index = static_cast<std::uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        }
+        m_slots[index].Live = true;
+        return handle<slot_id>(slot_id{ index, m_slots[index].Generation });
+    }
+
+    // handle_block is unused state of allocate_block, new slots are appended in order anyway
+    struct handle_block
+    {};
+
+    // allocate_block is to make room for _count more slots
+    handle_block allocate_block(std::size_t _count)
+    {
+        reserve(_count);
+        return {};
+    }
+
+    // allocate is to take a free slot, or append one
+    handle<slot_id> allocate(handle_block&) { return allocate(); }
+
+    // reserve is to make room for _count more slots
+    void reserve(std::size_t _count) { m_slots.reserve(m_slots.size() + _count); }
+
+    // deallocate is to free the slot, handles to it become stale
+    void deallocate(const handle<slot_id>& _handle)
+    {
+        if (!is_allocated(_handle))
+            return;
+        auto& slot = m_slots[_handle.id().Index];
+        slot.Live = false;
+        ++slot.Generation;
+        put_free(_handle.id().Index);
+    }
+
+    // is_allocated is to check if handle is allocated
+    bool is_allocated(const handle<slot_id>& _handle) const
+    {
+        const slot_id& id = _handle.id();
+        return id.Index < m_slots.size() && m_slots[id.Index].Live && m_slots[id.Index].Generation == id.Generation;
+    }
+
+    // allocate_at is to allocate a handle at specific slot and generation, fails if the slot is live or the
+    // generation is older than the one of the slot, so stale ids never become valid again
+    bool allocate_at(const handle<slot_id>& _handle)
+    {
+        const slot_id& id = _handle.id();
+        while (m_slots.size() <= id.Index) {
+            m_slots.emplace_back();
+            put_free(static_cast<std::uint32_t>(m_slots.size() - 1));
+        }
+        auto& slot = m_slots[id.Index];
+        if (slot.Live || id.Generation < slot.Generation)
+            return false;
+        take_free(id.Index);
+        slot.Live = true;
+        slot.Generation = id.Generation;
+        return true;
+    }
+
+  protected:
+    static constexpr std::uint32_t k_not_free = ~std::uint32_t{ 0 };
+
+    // slot is the state of a slot index, FreeAt is its position in the free list
+    struct slot
+    {
+        std::uint32_t Generation = 0;
+        std::uint32_t FreeAt = k_not_free;
+        bool Live = false;
+    };
+
+    // put_free is to append the slot to the free list
+    void put_free(std::uint32_t _index)
+    {
+        m_slots[_index].FreeAt = static_cast<std::uint32_t>(m_free_slots.size());
+        m_free_slots.push_back(_index);
+    }
+
+    // take_free is to remove the slot from the free list, the last free slot takes its position
+    void take_free(std::uint32_t _index)
+    {
+        const std::uint32_t position = m_slots[_index].FreeAt;
+        if (position == k_not_free)
+            return;
+        const std::uint32_t last = m_free_slots.back();
+        m_free_slots[position] = last;
+        m_slots[last].FreeAt = position;
+        m_free_slots.pop_back();
+        m_slots[_index].FreeAt = k_not_free;
+    }
+
+    std::vector<slot> m_slots;
+    std::vector<std::uint32_t> m_free_slots;
+};
 }
\ No newline at end of file
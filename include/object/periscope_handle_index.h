@@ -0,0 +1,95 @@
+#pragma once
+
+#include "object/periscope_handle.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// handle_index is map from handle ids to values
+template<typename underlying_type, typename value>
+class handle_index
+{
+  public:
+    // find is to look up the value of the id, nullptr if it is not indexed
+    value* find(const underlying_type& _id)
+    {
+        auto iter = m_values.find(_id);
+        return iter == m_values.end() ? nullptr : &iter->second;
+    }
+
+    // find is to look up the value of the id, nullptr if it is not indexed
+    const value* find(const underlying_type& _id) const
+    {
+        return const_cast<handle_index*>(this)->find(_id);
+    }
+
+    // contains is whether the id is indexed
+    bool contains(const underlying_type& _id) const { return m_values.contains(_id); }
+
+    // emplace is to index the value under the id
+    void emplace(const underlying_type& _id, const value& _value) { m_values.emplace(_id, _value); }
+
+    // erase is to remove the id from the index
+    void erase(const underlying_type& _id) { m_values.erase(_id); }
+
+    // reserve is to make room for _count more ids
+    void reserve(std::size_t _count) { m_values.reserve(m_values.size() + _count); }
+
+  private:
+    std::unordered_map<underlying_type, value> m_values;
+};
+
+// ------------------------ Specializations -----------------------
+// handle_index is specialization for slot ids, values are stored at the slot index and checked by generation
+template<typename value>
+class handle_index<slot_id, value>
+{
+  public:
+    // find is to look up the value of the id, nullptr if it is not indexed or stale
+    value* find(const slot_id& _id)
+    {
+        if (_id.Index >= m_entries.size())
+            return nullptr;
+        auto& entry = m_entries[_id.Index];
+        return entry.Live && entry.Generation == _id.Generation ? &entry.Value : nullptr;
+    }
+
+    // find is to look up the value of the id, nullptr if it is not indexed or stale
+    const value* find(const slot_id& _id) const { return const_cast<handle_index*>(this)->find(_id); }
+
+    // contains is whether the id is indexed
+    bool contains(const slot_id& _id) const { return find(_id) != nullptr; }
+
+    // emplace is to index the value under the id
+    void emplace(const slot_id& _id, const value& _value)
+    {
+        if (_id.Index >= m_entries.size())
+            m_entries.resize(_id.Index + 1);
+        m_entries[_id.Index] = entry{ _id.Generation, true, _value };
+    }
+
+    // erase is to remove the id from the index
+    void erase(const slot_id& _id)
+    {
+        if (find(_id))
+            m_entries[_id.Index].Live = false;
+    }
+
+    // reserve is to make room for _count more slots
+    void reserve(std::size_t _count) { m_entries.reserve(m_entries.size() + _count); }
+
+  private:
+    // entry is the value stored at a slot
+    struct entry
+    {
+        std::uint32_t Generation = 0;
+        bool Live = false;
+        value Value{};
+    };
+
+    std::vector<entry> m_entries;
+};
+}
\ No newline at end of file
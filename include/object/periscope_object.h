@@ -3,14 +3,37 @@
 #include "graph/periscope_graph_fwd.h"
 #include "object/periscope_handle.h"
 #include "object/periscope_object_properties.h"
+#include "tools/periscope_guard.h"
+#include "tools/periscope_string_pool.h"
 #include "type_hash/periscope_type_hash.h"
-
-#include <any>
-#include <map>
+#include "type_hash/periscope_type_index.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace periscope {
 // ------------------------ Main template -----------------------
 
+template<typename derived>
+class object;
+
+class class_def;
+class node;
+class link;
+class note;
+
+// object_types is the registry of the object types graphs store, objects of them are dispatched on by their dense
+// type index, new types must only be appended since snapshots tag objects by it
+using object_types = type_registry<type_list<class_def, node, link, note>>;
+
 // base_object is the base class for all objects with property management
 class base_object
 {
@@ -19,25 +42,18 @@ class base_object
     template<typename child_list>
     struct remove_child_properties_helper;
 
-    // remove_child_properties_helper is specialization for non-empty type_list
+    // remove_child_properties_helper is specialization for type_list
     template<typename... child_props>
     struct remove_child_properties_helper<type_list<child_props...>>
     {
         static void apply(base_object* self) { (self->template remove<child_props>(), ...); }
     };
 
-    // remove_child_properties_helper is specialization for empty type_list
-    template<>
-    struct remove_child_properties_helper<type_list<>>
-    {
-        static void apply(base_object* self) {}
-    };
-
     // check_parent_properties_helper is helper to check parent properties from type_list
     template<typename parent_list>
     struct check_parent_properties_helper;
 
-    // check_parent_properties_helper is specialization for non-empty type_list
+    // check_parent_properties_helper is specialization for type_list
     template<typename... parent_props>
     struct check_parent_properties_helper<type_list<parent_props...>>
     {
@@ -48,13 +64,6 @@ class base_object
         }
     };
 
-    // check_parent_properties_helper is specialization for empty type_list
-    template<>
-    struct check_parent_properties_helper<type_list<>>
-    {
-        static void apply(const base_object* self) {}
-    };
-
     // on_property_removed is callback when property is removed
     template<typename prop>
     void on_property_removed()
@@ -71,40 +80,94 @@ class base_object
         check_parent_properties_helper<parent_list>::apply(this);
     }
 
+    // storage_type is the storage type holding the property
+    template<typename prop>
+    using storage_type = property_storage<property_set_t<typename prop::owner_type>>;
+
+    // storage_of is the storage holding the property, nullptr if this object is not of the owner type
+    template<typename prop>
+    const storage_type<prop>* storage_of() const
+    {
+        using owner = typename prop::owner_type;
+        if constexpr (std::is_same_v<owner, base_object>) {
+            return &m_properties;
+        } else {
+            if (!is<owner>())
+                return nullptr;
+            return &static_cast<const object<owner>*>(this)->m_typed_properties;
+        }
+    }
+
+    // storage_of is the mutable storage holding the property
+    template<typename prop>
+    storage_type<prop>* storage_of()
+    {
+        return const_cast<storage_type<prop>*>(std::as_const(*this).template storage_of<prop>());
+    }
+
   protected:
     base_object() = default;
+    base_object(base_object&&) = default;
+
+    // base_object is to copy the properties of an object, the copy is bound to no handle until a graph adopts it, its
+    // strings are interned again so it doesn't depend on the string pool of the graph of _other
+    base_object(const base_object& _other)
+      : m_properties(_other.m_properties)
+      , m_string_pool(copy_pool())
+      , m_type_index(_other.m_type_index)
+    {
+        intern_strings<base_object>();
+    }
+
+    // intern_strings is to take the string properties of owner into the string pool of this object
+    template<typename owner>
+    void intern_strings()
+    {
+        type_list_for_each(property_set_t<owner>{}, [this]<typename prop>() {
+            if constexpr (std::is_same_v<typename prop::type, interned_string>) {
+                if (auto* storage = storage_of<prop>(); storage && storage->template has<prop>()) {
+                    interned_string& value = storage->template get<prop>().Value;
+                    value = intern(value);
+                }
+            }
+        });
+    }
 
   public:
     virtual ~base_object() = default;
 
   public:
     // to_string is interface to convert object to string representation
-    virtual std::string to_string(graph_type _graph_type = io().GraphType) const = 0;
+    virtual std::string to_string(const render_context& _context = {}) const = 0;
 
   public:
     // has is whether the property exists
     template<typename prop>
     bool has() const
     {
-        return m_properties.contains(static_hash<prop>());
+        const auto* storage = storage_of<prop>();
+        return storage && storage->template has<prop>();
     }
 
     // get is const accessor to property
     template<typename prop>
     const prop& get() const
     {
-        if (!has<prop>())
+        const auto* storage = storage_of<prop>();
+        if (!storage || !storage->template has<prop>())
             throw std::runtime_error("Property not found");
-        return std::any_cast<const prop&>(m_properties.at(static_hash<prop>()));
+        return storage->template get<prop>();
     }
 
-    // get is mutable accessor to property
+    // get is mutable accessor to property, the property may be changed through it so the fragments are invalidated
     template<typename prop>
     prop& get()
     {
-        if (!has<prop>())
+        auto* storage = storage_of<prop>();
+        if (!storage || !storage->template has<prop>())
             throw std::runtime_error("Property not found");
-        return std::any_cast<prop&>(m_properties[static_hash<prop>()]);
+        invalidate_fragments();
+        return storage->template get<prop>();
     }
 
     // is_printable_if_unset is to check if property is printable if unset
@@ -119,25 +182,45 @@ class base_object
 
     // str is to convert property to string representation
     template<typename prop>
-    std::string _V_str(graph_type _graph_type = io().GraphType) const
+    std::string _V_str(const render_context& _context = {}) const
     {
         if (!has<prop>()) {
             if constexpr (is_printable_if_unset<prop>::value) {
-                return prop::to_string_default(_graph_type);
+                return prop::to_string_default(_context);
             } else {
                 return "";
             }
         }
-        return prop::to_string(get<prop>(), _graph_type);
+        return prop::to_string(get<prop>(), _context);
     }
 
+    // _V_view is to view string property value without copying, empty if unset
+    template<typename prop>
+    std::string_view _V_view() const
+    {
+        static_assert(std::is_same_v<typename prop::type, interned_string>, "Property value must be a string");
+        if (!has<prop>())
+            return {};
+        return get<prop>().Value.view();
+    }
+
+    // intern is the string with the text in the string pool of the graph of this object, objects that don't belong
+    // to a graph intern into a pool of their own
+    interned_string intern(std::string_view _text) const { return strings().intern(_text); }
+
+    // intern is the string with the text of a string of any pool in the string pool of the graph of this object
+    interned_string intern(const interned_string& _string) const { return strings().intern(_string); }
+
     // create is to create a property if it doesn't exist
     template<typename prop>
     base_object& create()
     {
         on_property_added<prop>();
-        if (!has<prop>())
-            m_properties[static_hash<prop>()] = prop{};
+        auto* storage = storage_of<prop>();
+        if (!storage)
+            throw std::runtime_error("Property doesn't belong to this object");
+        storage->template emplace<prop>();
+        invalidate_fragments();
         return *this;
     }
 
@@ -156,18 +239,140 @@ class base_object
     base_object& remove()
     {
         on_property_removed<prop>();
-        m_properties.erase(static_hash<prop>());
+        if (auto* storage = storage_of<prop>())
+            storage->template reset<prop>();
+        invalidate_fragments();
         return *this;
     }
 
+    // is is whether the object is of type t, registered types are compared by their dense type index
+    template<typename t>
+    bool is() const
+    {
+        if constexpr (object_types::contains<t>)
+            return m_type_index == object_types::index<t>();
+        else
+            return m_properties.template get<OP_type>().Value == static_hash<t>();
+    }
+
+    // type_index is the index of the type of the object in object_types, object_types::size if it isn't registered
+    std::size_t type_index() const { return m_type_index; }
+
     std::shared_ptr<base_handle> get_handle() const { return m_handle; }
 
+    // get_handle_ref is the compact reference to the handle of this object inside its graph
+    handle_ref get_handle_ref() const { return m_handle ? m_handle->ref() : handle_ref(); }
+
+    // fragment is the text rendered for the graph type of the context, _render is called to write it again into the
+    // given output iterator if a property changed or a handle it printed has been unbound since the last call, the
+    // graph lets one render at a time use the caches
+    template<typename render>
+    const std::string& fragment(const render_context& _context, const render& _render) const
+    {
+        if (!m_fragments)
+            m_fragments = std::make_unique<fragment_cache>();
+        auto& entry = m_fragments->Entries[static_cast<std::size_t>(_context.GraphType)];
+        if (entry.Valid && refs_bound(entry))
+            return entry.Text;
+
+        entry.Valid = false;
+        entry.Text.clear();
+        entry.Refs.clear();
+        std::vector<handle_ref>* outer = std::exchange(recorded_refs(), &entry.Refs);
+        {
+            guard restore([outer] { recorded_refs() = outer; });
+            _render(std::back_inserter(entry.Text));
+        }
+        entry.Valid = true;
+        return entry.Text;
+    }
+
+  protected:
+    // print_ref is to print the handle referenced inside the graph of this object, references to deleted nodes print
+    // the handle they had
+    std::string print_ref(const handle_ref& _ref, const render_context& _context = {}) const
+    {
+        const base_handle* handle = nullptr;
+        if (m_handle_table) {
+            handle = m_handle_table->find(_ref);
+            if (handle && recorded_refs())
+                recorded_refs()->push_back(_ref);
+            else if (!handle)
+                handle = m_handle_table->find_retired(_ref);
+        }
+        if (!handle)
+            throw std::runtime_error("Referenced object not found");
+        return handle->print(_context);
+    }
+
   private:
-    std::map<type_hash_result, std::any> m_properties;
+    // fragment_entry is the text rendered for one graph type and the bound handles it printed
+    struct fragment_entry
+    {
+        std::string Text;
+        std::vector<handle_ref> Refs;
+        bool Valid = false;
+    };
+
+    // fragment_cache is the rendered text of the object per graph type, allocated on the first cached render
+    struct fragment_cache
+    {
+        std::array<fragment_entry, 2> Entries;
+    };
+
+    // copy_pool is the string pool copies made by the calling thread intern into, a pool of their own if it is null,
+    // a graph copying objects into itself points it to its own pool
+    static string_pool*& copy_pool()
+    {
+        thread_local string_pool* pool = nullptr;
+        return pool;
+    }
+
+    // strings is the string pool of the graph of this object, or the pool of its own created on first use
+    string_pool& strings() const
+    {
+        if (!m_string_pool) {
+            m_own_strings = std::make_unique<string_pool>();
+            m_string_pool = m_own_strings.get();
+        }
+        return *m_string_pool;
+    }
+
+    // recorded_refs is where print_ref records the bound handles printed by the fragment the calling thread renders
+    static std::vector<handle_ref>*& recorded_refs()
+    {
+        thread_local std::vector<handle_ref>* refs = nullptr;
+        return refs;
+    }
+
+    // refs_bound is whether the handles printed by the fragment are still bound, it is rendered again otherwise
+    bool refs_bound(const fragment_entry& _entry) const
+    {
+        return std::ranges::all_of(_entry.Refs,
+                                   [this](const handle_ref& _ref) { return m_handle_table->find(_ref) != nullptr; });
+    }
+
+    // invalidate_fragments is to drop the cached text after a property change
+    void invalidate_fragments()
+    {
+        if (!m_fragments)
+            return;
+        for (auto& entry : m_fragments->Entries)
+            entry.Valid = false;
+    }
+
+    property_storage<property_set_t<base_object>> m_properties;
     template<typename underlying_type>
     friend class graph;
+    template<typename derived>
+    friend class object;
 
     std::shared_ptr<base_handle> m_handle;
+    const handle_table* m_handle_table = nullptr;
+    mutable string_pool* m_string_pool = nullptr;
+    mutable std::unique_ptr<string_pool> m_own_strings;
+    mutable std::unique_ptr<fragment_cache> m_fragments;
+    std::uint16_t m_type_index = object_types::size;
 };
 
 // object is CRTP base class for typed objects with property management
@@ -175,7 +380,21 @@ template<typename derived>
 class object : public base_object
 {
   public:
-    object() = default;
+    object()
+    {
+        this->template set<OP_type>(static_hash<derived>());
+        m_type_index = object_types::index<derived>();
+    }
+
+    object(object&&) = default;
+
+    // object is to copy the properties of an object, strings included like base_object does
+    object(const object& _other)
+      : base_object(_other)
+      , m_typed_properties(_other.m_typed_properties)
+    {
+        intern_strings<derived>();
+    }
 
     // set is to set property value with type checking
     template<typename prop>
@@ -183,39 +402,66 @@ class object : public base_object
     {
         static_assert(std::is_base_of_v<typename prop::owner_type, derived>,
                       "Owner must be a derived class of prop::owner_type");
-        get_or_create<prop>().Value = _value;
+        if constexpr (std::is_same_v<typename prop::type, interned_string>)
+            get_or_create<prop>().Value = intern(_value);
+        else
+            get_or_create<prop>().Value = _value;
+        return *this;
+    }
+
+    // set overload: intern the text of string properties into the string pool of the graph
+    template<typename prop>
+        requires std::is_same_v<typename prop::type, interned_string>
+    object& set(std::string_view _value)
+    {
+        static_assert(std::is_base_of_v<typename prop::owner_type, derived>,
+                      "Owner must be a derived class of prop::owner_type");
+        get_or_create<prop>().Value = intern(_value);
         return *this;
     }
 
     // set overload: accept objects with get_handle() for handle properties
     template<typename prop, typename t>
-        requires(std::is_same_v<typename prop::type, std::shared_ptr<base_handle>> && has_get_handle<t>::value &&
+        requires(std::is_same_v<typename prop::type, handle_ref> && has_get_handle<t>::value &&
                  !std::is_same_v<t, typename prop::type>)
     object& set(const t& _value)
     {
         static_assert(std::is_base_of_v<typename prop::owner_type, derived>,
                       "Owner must be a derived class of prop::owner_type");
-        get_or_create<prop>().Value = _value.get_handle();
+        if constexpr (std::is_base_of_v<base_object, t>)
+            get_or_create<prop>().Value = _value.get_handle_ref();
+        else
+            get_or_create<prop>().Value = handle_ref(_value.get_handle());
         return *this;
     }
 
   public:
     // to_string is implementation of base_object::to_string
-    std::string to_string(graph_type _graph_type = io().GraphType) const override
+    std::string to_string(const render_context& _context = {}) const override
+    {
+        std::string str;
+        render_to(std::back_inserter(str), _context);
+        return str;
+    }
+
+    // render_to is to write string representation to output iterator
+    template<typename output_iterator>
+    output_iterator render_to(output_iterator _out, const render_context& _context = {}) const
     {
         if (!has<OP_printable>())
-            return "";
-        return static_cast<const derived*>(this)->to_string_impl(_graph_type);
+            return _out;
+        return static_cast<const derived*>(this)->render_to_impl(_out, _context);
     }
 
-    // to_string_impl is default implementation for derived classes
-    std::string to_string_impl(graph_type _graph_type = io().GraphType) const
+    // render_to_impl is default implementation for derived classes
+    template<typename output_iterator>
+    output_iterator render_to_impl(output_iterator _out, const render_context& _context = {}) const
     {
-        if (has<OP_name>())
-            return get<OP_name>().Value;
-        return "";
+        return std::ranges::copy(_V_view<OP_name>(), _out).out;
     }
 
-  protected:
+  private:
+    property_storage<property_set_t<derived>> m_typed_properties;
+    friend class base_object;
 };
 }
\ No newline at end of file
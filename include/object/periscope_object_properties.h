@@ -2,8 +2,11 @@
 
 #include "graph/periscope_graph_fwd.h"
 #include "object/periscope_handle.h"
+#include "object/periscope_property_storage.h"
+#include "tools/periscope_string_pool.h"
 #include "type_hash/periscope_type_hash.h"
 #include "type_traits/periscope_type_list.h"
+#include <memory>
 #include <string>
 #include <type_traits>
 
@@ -56,12 +59,12 @@ struct base_property
     using parent_properties = type_list<>;
 };
 
-// OP_name is property for object name
-struct OP_name : base_property<std::string, base_object>
+// OP_name is property for object name, interned in the string pool of the graph
+struct OP_name : base_property<interned_string, base_object>
 {
-    static std::string to_string(const OP_name& _property, graph_type _graph_type = io().GraphType)
+    static std::string to_string(const OP_name& _property, const render_context& _context = {})
     {
-        return _property.Value;
+        return std::string(_property.Value.view());
     }
 };
 
@@ -72,4 +75,11 @@ struct OP_printable : base_property<bool, base_object>
 // OP_type is property for object type hash
 struct OP_type : base_property<type_hash_result, base_object>
 {};
+
+// property_set is specialization for properties shared by all objects
+template<>
+struct property_set<base_object>
+{
+    using type = type_list<OP_name, OP_printable, OP_type>;
+};
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "type_traits/periscope_type_list.h"
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// property_set is the list of properties declared by an object type
+template<typename owner>
+struct property_set
+{
+    using type = type_list<>;
+};
+
+// property_set_t is the list of properties declared by an object type
+template<typename owner>
+using property_set_t = typename property_set<owner>::type;
+
+// property_storage is inline storage of a property set with a presence bitmask
+template<typename list>
+class property_storage;
+
+// ---------------------- Specialization(this) ------------------
+// property_storage keeps one default constructed slot per property, the mask tells which slots are set
+template<typename... props>
+class property_storage<type_list<props...>>
+{
+    using list_type = type_list<props...>;
+    using mask_type = std::uint64_t;
+    static_assert(sizeof...(props) <= sizeof(mask_type) * 8, "Too many properties for one property set");
+
+  public:
+    // contains is whether the property belongs to this set
+    template<typename prop>
+    static constexpr bool contains = type_list_contains_v<list_type, prop>;
+
+    // has is whether the property slot is set
+    template<typename prop>
+    bool has() const
+    {
+        return (m_mask & bit<prop>()) != 0;
+    }
+
+    // get is const accessor to property slot
+    template<typename prop>
+    const prop& get() const
+    {
+        return std::get<prop>(m_slots);
+    }
+
+    // get is mutable accessor to property slot
+    template<typename prop>
+    prop& get()
+    {
+        return std::get<prop>(m_slots);
+    }
+
+    // emplace is to mark the property slot as set
+    template<typename prop>
+    prop& emplace()
+    {
+        m_mask |= bit<prop>();
+        return std::get<prop>(m_slots);
+    }
+
+    // reset is to release the property slot value and mark it as unset
+    template<typename prop>
+    void reset()
+    {
+        if (!has<prop>())
+            return;
+        std::get<prop>(m_slots) = prop{};
+        m_mask &= ~bit<prop>();
+    }
+
+  private:
+    // bit is the presence bit of the property
+    template<typename prop>
+    static constexpr mask_type bit()
+    {
+        static_assert(contains<prop>, "Property is not declared in the property set of its owner");
+        return mask_type{ 1 } << type_list_index_v<prop, list_type>;
+    }
+
+    std::tuple<props...> m_slots;
+    mask_type m_mask = 0;
+};
+}
\ No newline at end of file
@@ -5,6 +5,10 @@
 
 #include "graph/periscope_graph.h"
 #include "graph/periscope_graph_properties.h"
+#include "graph/periscope_mermaid_parser.h"
+#include "graph/periscope_recorder.h"
+#include "graph/periscope_snapshot.h"
+#include "graph/periscope_static_graph.h"
 #include "link/periscope_link.h"
 #include "link/periscope_link_properties.h"
 #include "misc/periscope_class_def.h"
@@ -14,4 +18,8 @@
 #include "node/periscope_node.h"
 #include "node/periscope_node_properties.h"
 #include "tools/periscope_guard.h"
-#include "tools/periscope_nested_map_op.h"
\ No newline at end of file
+#include "tools/periscope_nested_map_op.h"
+#include "tools/periscope_object_pool.h"
+#include "tools/periscope_sampler.h"
+#include "tools/periscope_worker_pool.h"
+#include "type_hash/periscope_type_index.h"
\ No newline at end of file
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// slab_pool is fixed size block allocator, blocks are carved out of slabs and recycled through a free list, blocks
+// may be released from other threads through deallocate_remote while the owning thread allocates
+class slab_pool
+{
+  public:
+    slab_pool() = default;
+    slab_pool(const slab_pool&) = delete;
+    slab_pool& operator=(const slab_pool&) = delete;
+
+    ~slab_pool()
+    {
+        for (auto* slab : m_slabs)
+            ::operator delete(slab, std::align_val_t(m_block_align));
+    }
+
+    // allocate is to take a block, the first allocation fixes the block size of the pool
+    void* allocate(std::size_t _size, std::size_t _align)
+    {
+        set_layout(_size, _align);
+        if (!m_free)
+            m_free = m_remote_free.exchange(nullptr, std::memory_order_acquire);
+        if (m_free) {
+            free_block* block = m_free;
+            m_free = block->Next;
+            return block;
+        }
+        if (m_cursor == m_end)
+            grow();
+        void* block = m_cursor;
+        m_cursor += m_block_size;
+        return block;
+    }
+
+    // reserve is to make room for _count more blocks in one slab, so taking them doesn't grow the pool, the rest of
+    // the current slab is kept on the free list
+    void reserve(std::size_t _size, std::size_t _align, std::size_t _count)
+    {
+        set_layout(_size, _align);
+        if (static_cast<std::size_t>(m_end - m_cursor) / m_block_size >= _count)
+            return;
+        for (; m_cursor != m_end; m_cursor += m_block_size)
+            deallocate(m_cursor);
+        grow(_count);
+    }
+
+    // deallocate is to return a block to the free list, only from the thread allocating
+    void deallocate(void* _block)
+    {
+        auto* block = static_cast<free_block*>(_block);
+        block->Next = m_free;
+        m_free = block;
+    }
+
+    // deallocate_remote is to return a block from any thread, it is pushed on a lock-free stack the allocating thread
+    // takes whole once its free list is empty, so popping never races with pushes
+    void deallocate_remote(void* _block)
+    {
+        auto* block = static_cast<free_block*>(_block);
+        block->Next = m_remote_free.load(std::memory_order_relaxed);
+        while (!m_remote_free.compare_exchange_weak(
+          block->Next, block, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+  private:
+    // free_block is the link stored in a released block
+    struct free_block
+    {
+        free_block* Next;
+    };
+
+    // set_layout is to fix the block size of the pool on first use, later layouts must fit in it
+    void set_layout(std::size_t _size, std::size_t _align)
+    {
+        if (m_block_size == 0) {
+            m_block_align = std::max(_align, alignof(free_block));
+            m_block_size = (std::max(_size, sizeof(free_block)) + m_block_align - 1) / m_block_align * m_block_align;
+        } else if (_size > m_block_size || _align > m_block_align) {
+            throw std::invalid_argument("slab_pool: block layout doesn't match the pool");
+        }
+    }
+
+    // grow is to append a slab of at least _min_blocks blocks, slabs double in size up to k_max_blocks_per_slab
+    void grow(std::size_t _min_blocks = 0)
+    {
+        m_blocks_per_slab =
+          m_slabs.empty() ? k_min_blocks_per_slab : std::min(m_blocks_per_slab * 2, k_max_blocks_per_slab);
+        const std::size_t blocks = std::max(m_blocks_per_slab, _min_blocks);
+        auto* slab =
+          static_cast<std::byte*>(::operator new(blocks * m_block_size, std::align_val_t(m_block_align)));
+        m_slabs.push_back(slab);
+        m_cursor = slab;
+        m_end = slab + blocks * m_block_size;
+    }
+
+    static constexpr std::size_t k_min_blocks_per_slab = 16;
+    static constexpr std::size_t k_max_blocks_per_slab = 4096;
+
+    std::size_t m_block_size = 0;
+    std::size_t m_block_align = alignof(free_block);
+    std::size_t m_blocks_per_slab = 0;
+    std::vector<std::byte*> m_slabs;
+    std::byte* m_cursor = nullptr;
+    std::byte* m_end = nullptr;
+    free_block* m_free = nullptr;
+    std::atomic<free_block*> m_remote_free{ nullptr };
+};
+
+// pool_allocator is allocator drawing single elements from a shared slab_pool, the pool lives as long as any copy,
+// elements are allocated by one thread but may be released by any, like the handles shared out of a graph
+template<typename value>
+class pool_allocator
+{
+  public:
+    using value_type = value;
+
+    pool_allocator()
+      : m_pool(std::make_shared<slab_pool>())
+    {
+    }
+
+    template<typename other>
+    pool_allocator(const pool_allocator<other>& _other)
+      : m_pool(_other.m_pool)
+    {
+    }
+
+    // allocate is to allocate n elements, only single elements come from the pool
+    value* allocate(std::size_t _n)
+    {
+        if (_n != 1)
+            return std::allocator<value>().allocate(_n);
+        return static_cast<value*>(m_pool->allocate(sizeof(value), alignof(value)));
+    }
+
+    // deallocate is to release n elements
+    void deallocate(value* _ptr, std::size_t _n)
+    {
+        if (_n != 1)
+            return std::allocator<value>().deallocate(_ptr, _n);
+        m_pool->deallocate_remote(_ptr);
+    }
+
+    // operator== is whether both allocators share the pool
+    template<typename other>
+    bool operator==(const pool_allocator<other>& _other) const
+    {
+        return m_pool == _other.m_pool;
+    }
+
+  private:
+    template<typename>
+    friend class pool_allocator;
+
+    std::shared_ptr<slab_pool> m_pool;
+};
+
+// base_object_pool is type erased interface of object pools sharing a base class
+template<typename base>
+class base_object_pool
+{
+  public:
+    virtual ~base_object_pool() = default;
+
+    // destroy is to destruct the object and recycle its block
+    virtual void destroy(base* _object) = 0;
+};
+
+// object_pool is pool of objects of type t
+template<typename t, typename base = t>
+class object_pool : public base_object_pool<base>
+{
+  public:
+    // create is to construct an object in a pooled block
+    template<typename... args>
+    t* create(args&&... _args)
+    {
+        void* block = m_slabs.allocate(sizeof(t), alignof(t));
+        try {
+            return new (block) t(std::forward<args>(_args)...);
+        } catch (...) {
+            m_slabs.deallocate(block);
+            throw;
+        }
+    }
+
+    // reserve is to make room for _count more objects, so creating them doesn't grow the pool
+    void reserve(std::size_t _count) { m_slabs.reserve(sizeof(t), alignof(t), _count); }
+
+    // destroy is implementation of base_object_pool::destroy
+    void destroy(base* _object) override
+    {
+        t* object = static_cast<t*>(_object);
+        object->~t();
+        m_slabs.deallocate(object);
+    }
+
+  private:
+    slab_pool m_slabs;
+};
+
+// pool_deleter is deleter returning objects to the pool they were created from
+template<typename base>
+struct pool_deleter
+{
+    base_object_pool<base>* Pool = nullptr;
+
+    void operator()(base* _object) const { Pool->destroy(_object); }
+};
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// sampler is interface of policies deciding whether an event between two objects is recorded, policies are called
+// from any recording thread, so they neither lock nor allocate
+template<typename underlying_type>
+class sampler
+{
+  public:
+    virtual ~sampler() = default;
+
+    // sample is whether to keep the event from _source to _target
+    virtual bool sample(const underlying_type& _source, const underlying_type& _target) = 0;
+};
+
+// every_nth_sampler is policy keeping one event out of every n
+template<typename underlying_type>
+class every_nth_sampler : public sampler<underlying_type>
+{
+  public:
+    explicit every_nth_sampler(std::uint64_t _n)
+      : m_n(_n)
+    {
+        if (_n == 0)
+            throw std::invalid_argument("every_nth_sampler: n must be positive");
+    }
+
+    // sample is implementation of sampler::sample
+    bool sample(const underlying_type&, const underlying_type&) override
+    {
+        return m_count.fetch_add(1, std::memory_order_relaxed) % m_n == 0;
+    }
+
+  private:
+    const std::uint64_t m_n;
+    std::atomic<std::uint64_t> m_count{ 0 };
+};
+
+// probability_sampler is policy keeping every event with a fixed probability, drawn from a thread local generator
+template<typename underlying_type>
+class probability_sampler : public sampler<underlying_type>
+{
+  public:
+    explicit probability_sampler(double _probability)
+    {
+        if (!(_probability >= 0.0 && _probability <= 1.0))
+            throw std::invalid_argument("probability_sampler: probability must be in [0, 1]");
+        m_always = _probability == 1.0;
+        m_threshold = static_cast<std::uint64_t>(_probability * 18446744073709551616.0);
+    }
+
+    // sample is implementation of sampler::sample
+    bool sample(const underlying_type&, const underlying_type&) override
+    {
+        return m_always || next_random() < m_threshold;
+    }
+
+  private:
+    // next_random is the next value of the xorshift64* generator of the calling thread
+    static std::uint64_t next_random()
+    {
+        thread_local std::uint64_t state = seed();
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    // seed is splitmix64 of the address of a thread local and the time, never zero
+    static std::uint64_t seed()
+    {
+        thread_local char anchor;
+        std::uint64_t z = reinterpret_cast<std::uintptr_t>(&anchor) ^
+                          static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        z += 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return z ? z : 1;
+    }
+
+    bool m_always = false;
+    std::uint64_t m_threshold = 0;
+};
+
+// token_bucket_sampler is policy limiting each (source, target) pair to a rate with bursts, pairs are kept in an
+// open-addressed table sized up front, ids that fit in 64 bits are stored as they are so every pair has its own
+// limit, wider ids are stored as their hashes, once the table is full new pairs share one overflow limit
+template<typename underlying_type>
+class token_bucket_sampler : public sampler<underlying_type>
+{
+  public:
+    // token_bucket_sampler is to allow _rate events per second per pair, up to _burst at once, for up to _pairs pairs
+    token_bucket_sampler(double _rate, std::uint64_t _burst = 1, std::size_t _pairs = 4096)
+      : m_buckets(std::bit_ceil(std::max<std::size_t>(_pairs, 1)))
+    {
+        if (!(_rate > 0.0) || _burst == 0)
+            throw std::invalid_argument("token_bucket_sampler: rate and burst must be positive");
+        m_interval = std::max<std::int64_t>(1, static_cast<std::int64_t>(1e9 / _rate));
+        m_tolerance = m_interval * static_cast<std::int64_t>(_burst - 1);
+    }
+
+    // sample is implementation of sampler::sample, the bucket keeps the theoretical arrival time of the next event
+    bool sample(const underlying_type& _source, const underlying_type& _target) override
+    {
+        auto& arrival = bucket_of(key_of(_source), key_of(_target));
+        const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count();
+        std::int64_t expected = arrival.load(std::memory_order_relaxed);
+        while (true) {
+            const std::int64_t start = std::max(expected, now);
+            if (start - now > m_tolerance)
+                return false;
+            if (arrival.compare_exchange_weak(expected, start + m_interval, std::memory_order_relaxed))
+                return true;
+        }
+    }
+
+  private:
+    // bucket_state is the state of a slot of the table, a pair is written once between claiming and ready
+    enum bucket_state : std::uint32_t
+    {
+        k_empty,
+        k_claiming,
+        k_ready,
+    };
+
+    // bucket is the limit of one pair
+    struct bucket
+    {
+        std::atomic<std::uint32_t> State{ k_empty };
+        std::uint64_t Source = 0;
+        std::uint64_t Target = 0;
+        std::atomic<std::int64_t> Arrival{ 0 };
+    };
+
+    // key_of is the id as stored in the table, the id itself when it fits in 64 bits
+    static std::uint64_t key_of(const underlying_type& _id)
+    {
+        if constexpr (std::is_trivially_copyable_v<underlying_type> &&
+                      sizeof(underlying_type) <= sizeof(std::uint64_t)) {
+            std::uint64_t key = 0;
+            std::memcpy(&key, &_id, sizeof(underlying_type));
+            return key;
+        } else {
+            return std::hash<underlying_type>{}(_id);
+        }
+    }
+
+    // bucket_of is the arrival time of the pair, its slot is claimed on first use by probing from its hash
+    std::atomic<std::int64_t>& bucket_of(std::uint64_t _source, std::uint64_t _target)
+    {
+        std::uint64_t hash = _source * 0x9E3779B97F4A7C15ULL;
+        hash ^= _target + 0x632BE59BD9B4E019ULL + (hash << 6) + (hash >> 2);
+        hash ^= hash >> 29;
+        const std::size_t mask = m_buckets.size() - 1;
+        for (std::size_t probe = 0; probe <= mask; ++probe) {
+            bucket& slot = m_buckets[(hash + probe) & mask];
+            std::uint32_t state = slot.State.load(std::memory_order_acquire);
+            if (state == k_empty) {
+                if (slot.State.compare_exchange_strong(state, k_claiming, std::memory_order_acquire)) {
+                    slot.Source = _source;
+                    slot.Target = _target;
+                    slot.State.store(k_ready, std::memory_order_release);
+                    return slot.Arrival;
+                }
+            }
+            // the pair of a slot being claimed is written right after, so it is only waited for briefly
+            while (state == k_claiming)
+                state = slot.State.load(std::memory_order_acquire);
+            if (slot.Source == _source && slot.Target == _target)
+                return slot.Arrival;
+        }
+        return m_overflow;
+    }
+
+    std::int64_t m_interval = 0;
+    std::int64_t m_tolerance = 0;
+    std::vector<bucket> m_buckets;
+    std::atomic<std::int64_t> m_overflow{ 0 };
+};
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+class string_pool;
+
+// interned_string is a string stored once in a string_pool, it is the size of a pointer and strings interned by the
+// same pool are equal exactly when they point to the same entry, the empty string points to none
+class interned_string
+{
+  public:
+    interned_string() = default;
+
+    // view is the text of the string, it lives as long as the pool that interned it
+    std::string_view view() const { return m_entry ? std::string_view(m_entry->Text) : std::string_view(); }
+    operator std::string_view() const { return view(); }
+
+    // str is the text as the std::string stored by the pool, for code reading the property as a std::string
+    const std::string& str() const { return m_entry ? m_entry->Text : empty_text(); }
+    operator const std::string&() const { return str(); }
+
+    const char* c_str() const { return str().c_str(); }
+    const char* data() const { return view().data(); }
+    std::size_t size() const { return m_entry ? m_entry->Text.size() : 0; }
+    bool empty() const { return m_entry == nullptr; }
+
+    // id is the identity of the string inside its pool, 0 for the empty string
+    std::uintptr_t id() const { return reinterpret_cast<std::uintptr_t>(m_entry); }
+
+    // hash is the hash of the text, computed once when the string was interned
+    std::size_t hash() const { return m_entry ? m_entry->Hash : std::hash<std::string_view>{}({}); }
+
+    // operator== compares the entries of strings of the same pool, only strings of different pools compare texts
+    friend bool operator==(const interned_string& _lhs, const interned_string& _rhs)
+    {
+        if (_lhs.m_entry == _rhs.m_entry)
+            return true;
+        if (!_lhs.m_entry || !_rhs.m_entry || _lhs.m_entry->Pool == _rhs.m_entry->Pool)
+            return false;
+        return _lhs.m_entry->Hash == _rhs.m_entry->Hash && _lhs.m_entry->Text == _rhs.m_entry->Text;
+    }
+
+    friend bool operator==(const interned_string& _lhs, std::string_view _rhs) { return _lhs.view() == _rhs; }
+
+  private:
+    // entry is a string of the pool with its hash
+    struct entry
+    {
+        std::string Text;
+        std::size_t Hash;
+        const string_pool* Pool;
+    };
+
+    explicit interned_string(const entry* _entry)
+      : m_entry(_entry)
+    {
+    }
+
+    // empty_text is the text of the empty string
+    static const std::string& empty_text()
+    {
+        static const std::string empty;
+        return empty;
+    }
+
+    const entry* m_entry = nullptr;
+    friend class string_pool;
+};
+
+// string_pool is deduplicating storage of strings, interning a text already stored returns the same string, entries
+// are kept until the pool is destroyed
+class string_pool
+{
+  public:
+    string_pool() = default;
+    string_pool(const string_pool&) = delete;
+    string_pool& operator=(const string_pool&) = delete;
+
+    // intern is the string of the pool with the text, stored on first use
+    interned_string intern(std::string_view _text)
+    {
+        if (_text.empty())
+            return {};
+        const std::size_t hash = std::hash<std::string_view>{}(_text);
+        auto iter = m_lookup.find(lookup_key{ _text, hash });
+        if (iter != m_lookup.end())
+            return interned_string(*iter);
+        const entry& stored = m_entries.emplace_back(entry{ std::string(_text), hash, this });
+        m_lookup.insert(&stored);
+        return interned_string(&stored);
+    }
+
+    // intern is the string of the pool with the text of a string of any pool
+    interned_string intern(const interned_string& _string)
+    {
+        if (!_string.m_entry || _string.m_entry->Pool == this)
+            return _string;
+        return intern(_string.view());
+    }
+
+    // size is the number of distinct strings stored
+    std::size_t size() const { return m_entries.size(); }
+
+  private:
+    using entry = interned_string::entry;
+
+    // lookup_key is a text being looked up with its hash
+    struct lookup_key
+    {
+        std::string_view Text;
+        std::size_t Hash;
+    };
+
+    // entry_hash is transparent hash of entries, so lookups don't store the text
+    struct entry_hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(const entry* _entry) const { return _entry->Hash; }
+        std::size_t operator()(const lookup_key& _key) const { return _key.Hash; }
+    };
+
+    // entry_equal is transparent comparison of entries with texts being looked up
+    struct entry_equal
+    {
+        using is_transparent = void;
+
+        bool operator()(const entry* _lhs, const entry* _rhs) const { return _lhs == _rhs; }
+        bool operator()(const lookup_key& _lhs, const entry* _rhs) const { return _lhs.Text == _rhs->Text; }
+        bool operator()(const entry* _lhs, const lookup_key& _rhs) const { return _lhs->Text == _rhs.Text; }
+    };
+
+    // entries don't move when the deque grows, so strings keep pointing to them
+    std::deque<entry> m_entries;
+    std::unordered_set<const entry*, entry_hash, entry_equal> m_lookup;
+};
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// worker_pool is fixed set of threads running indexed tasks, the calling thread works along with them
+class worker_pool
+{
+  public:
+    // worker_pool is to start the workers, _concurrency counts the calling thread
+    explicit worker_pool(std::size_t _concurrency = std::thread::hardware_concurrency())
+    {
+        std::size_t workers = std::max<std::size_t>(_concurrency, 1) - 1;
+        m_workers.reserve(workers);
+        for (std::size_t i = 0; i < workers; ++i)
+            m_workers.emplace_back([this] { work_loop(); });
+    }
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    ~worker_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    // concurrency is the number of threads running tasks, including the calling thread
+    std::size_t concurrency() const { return m_workers.size() + 1; }
+
+    // run is to call _task for every index below _count and wait for all of them, the first exception is rethrown,
+    // concurrent callers take turns, a task must not call run on the pool running it
+    void run(std::size_t _count, const std::function<void(std::size_t)>& _task)
+    {
+        if (_count == 0)
+            return;
+
+        std::lock_guard<std::mutex> job(m_run_mutex);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task = &_task;
+        m_count = _count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_done.store(0, std::memory_order_relaxed);
+        m_error = nullptr;
+        ++m_generation;
+        lock.unlock();
+        m_wake.notify_all();
+
+        work(_task, _count);
+
+        // workers that joined the job still hold the task, wait for them to leave before it goes out of scope
+        lock.lock();
+        m_finished.wait(lock, [this] { return m_done.load(std::memory_order_acquire) == m_count && m_active == 0; });
+        m_task = nullptr;
+        if (m_error)
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+
+  private:
+    // work_loop is the body of a worker thread
+    void work_loop()
+    {
+        std::uint64_t seen = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, seen] { return m_stop || (m_task && m_generation != seen); });
+            if (m_stop)
+                return;
+            seen = m_generation;
+            const auto* task = m_task;
+            std::size_t count = m_count;
+            ++m_active;
+            lock.unlock();
+
+            work(*task, count);
+
+            lock.lock();
+            --m_active;
+            lock.unlock();
+            m_finished.notify_all();
+        }
+    }
+
+    // work is to take task indices until none are left
+    void work(const std::function<void(std::size_t)>& _task, std::size_t _count)
+    {
+        while (true) {
+            std::size_t index = m_next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= _count)
+                return;
+            try {
+                _task(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error)
+                    m_error = std::current_exception();
+            }
+            if (m_done.fetch_add(1, std::memory_order_acq_rel) + 1 == _count) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_finished.notify_all();
+            }
+        }
+    }
+
+  private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_run_mutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_finished;
+    const std::function<void(std::size_t)>* m_task = nullptr;
+    std::size_t m_count = 0;
+    std::atomic<std::size_t> m_next{ 0 };
+    std::atomic<std::size_t> m_done{ 0 };
+    std::size_t m_active = 0;
+    std::uint64_t m_generation = 0;
+    std::exception_ptr m_error;
+    bool m_stop = false;
+};
+}
\ No newline at end of file
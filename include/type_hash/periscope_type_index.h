@@ -0,0 +1,93 @@
+#pragma once
+
+#include "type_hash/periscope_type_hash.h"
+#include "type_traits/periscope_type_list.h"
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace periscope {
+// ------------------------ Main template -----------------------
+
+// type_registry is dense numbering of the types of a list from 0 to size - 1, so objects can be dispatched on by
+// indexing tables instead of comparing static hashes
+template<typename list>
+struct type_registry;
+
+namespace internal {
+// distinct_hashes is whether no two hashes of the array are equal
+template<std::size_t size>
+constexpr bool
+distinct_hashes(const std::array<type_hash_result, size>& _hashes)
+{
+    for (std::size_t i = 0; i < size; ++i) {
+        for (std::size_t j = i + 1; j < size; ++j) {
+            if (_hashes[i] == _hashes[j])
+                return false;
+        }
+    }
+    return true;
+}
+}
+
+// ---------------------- Specialization(this) ------------------
+// type_registry numbers the types in list order, new types must only be appended so the indices of the others stay
+template<typename... types>
+struct type_registry<type_list<types...>>
+{
+    using list_type = type_list<types...>;
+
+    // size is the number of types, and the index of the types that aren't registered
+    static constexpr std::size_t size = sizeof...(types);
+
+    // hashes are the static hashes of the types in index order
+    static constexpr std::array<type_hash_result, size> hashes{ static_hash<types>()... };
+
+    // distinct is whether the static hashes of the types don't collide, so the hash of a type identifies it
+    static constexpr bool distinct = internal::distinct_hashes(hashes);
+    static_assert(distinct, "static_hash collision between registered types");
+
+    // contains is whether the type is registered
+    template<typename type>
+    static constexpr bool contains = type_list_contains_v<list_type, type>;
+
+    // index is the dense index of the type, size if it isn't registered
+    template<typename type>
+    static constexpr std::size_t index()
+    {
+        if constexpr (contains<type>)
+            return type_list_index_v<type, list_type>;
+        else
+            return size;
+    }
+
+    // index_of is the dense index of the type with the static hash, size if it isn't registered
+    static constexpr std::size_t index_of(type_hash_result _hash)
+    {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (hashes[i] == _hash)
+                return i;
+        }
+        return size;
+    }
+
+    // visit is to call _callback.template operator()<type>() for the type with the index through a table of the
+    // calls, the index must be below size
+    template<typename callback>
+    static decltype(auto) visit(std::size_t _index, callback&& _callback)
+    {
+        using result = std::common_reference_t<decltype(_callback.template operator()<types>())...>;
+        using thunk = result (*)(callback&);
+        static constexpr thunk table[] = { &call<types, callback, result>... };
+        return table[_index](_callback);
+    }
+
+  private:
+    // call is the entry of the visit table for the type
+    template<typename type, typename callback, typename result>
+    static result call(callback& _callback)
+    {
+        return _callback.template operator()<type>();
+    }
+};
+}
\ No newline at end of file
@@ -103,6 +103,14 @@ struct type_list_transform;
 template<typename list, template<typename> class transformer>
 using type_list_transform_t = typename type_list_transform<list, transformer>::type;
 
+// type_list_for_each is to call _callback.template operator()<type>() for every type of the list in order
+template<typename... types, typename callback>
+constexpr void
+type_list_for_each(type_list<types...>, const callback& _callback)
+{
+    (_callback.template operator()<types>(), ...);
+}
+
 // ---------------------- Specialization(this) ------------------
 
 // Specialization: type_list is a type_list
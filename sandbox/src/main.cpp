@@ -1,6 +1,5 @@
 #include "periscope.h"
 #include <iostream>
-#include <map>
 
 using namespace periscope;
 
@@ -38,13 +37,13 @@ example1_flowchart()
     end.set<OP_name>("End").set<NP_shape>(NP_shape::k_rectangle).set<NP_class_def>("End");
 
     // Create links
-    link& link1 = _graph.new_object<link>();
+    periscope::link& link1 = _graph.new_object<periscope::link>();
     link1.set<LP_source>(start).set<LP_target>(process).set<LP_style>(LP_style::k_solid | LP_style::k_arrow_mask);
 
-    link& link2 = _graph.new_object<link>();
+    periscope::link& link2 = _graph.new_object<periscope::link>();
     link2.set<LP_source>(process).set<LP_target>(decision).set<LP_style>(LP_style::k_solid | LP_style::k_arrow_mask);
 
-    link& link3 = _graph.new_object<link>();
+    periscope::link& link3 = _graph.new_object<periscope::link>();
     link3.set<LP_source>(decision)
       .set<LP_target>(end)
       .set<LP_style>(LP_style::k_solid | LP_style::k_arrow_mask)
@@ -67,6 +66,7 @@ class Service
     Service(const std::string& n)
       : name(n)
     {
+        get_hook_recorder().participant(this, name);
     }
 
     static graph<const void*>& get_hook_graph()
@@ -75,32 +75,21 @@ class Service
         return hook_graph;
     }
 
+    // hooks may fire on any thread, the recorder buffers them per thread until the graph is printed
+    static recorder<const void*>& get_hook_recorder()
+    {
+        static recorder<const void*> hook_recorder(get_hook_graph());
+        return hook_recorder;
+    }
+
     void send_request(Service* target, const std::string& msg)
     {
-        auto& hook_graph = get_hook_graph();
-        static std::map<const void*, bool> registered;
-
-        handle<const void*> this_handle(reinterpret_cast<const void*>(this));
-        handle<const void*> target_handle(reinterpret_cast<const void*>(target));
-
-        if (!registered[this]) {
-            hook_graph.new_object_at<node>(this_handle).set<OP_name>(name);
-            registered[this] = true;
-        }
-        if (!registered[target]) {
-            hook_graph.new_object_at<node>(target_handle).set<OP_name>(target->name);
-            registered[target] = true;
-        }
-
-        link& req = hook_graph.new_object<link>();
-        auto src_handle = hook_graph.access<node>(this_handle).get_handle();
-        auto dst_handle = hook_graph.access<node>(target_handle).get_handle();
-        req.set<LP_source>(src_handle).set<LP_target>(dst_handle).set<OP_name>(msg);
+        get_hook_recorder().message(this, target, msg);
     }
 
     static void print_graph()
     {
-        auto& hook_graph = get_hook_graph();
+        auto& hook_graph = get_hook_recorder().flush();
         hook_graph.template set<GP_type>(graph_type::k_sequence)
           .template set<GP_output_format>(graph_output_format::k_markdown)
           .template set<GP_sequence_show_number>(true);
@@ -0,0 +1,633 @@
+#include "periscope.h"
+#include <array>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace periscope;
+
+// Regression tests of the graph/object API, every test throws test_failure on the first failed check
+// Usage: periscope_tests [test name]
+
+// test_failure is the error a failed check throws
+struct test_failure : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+// check is to fail the running test if the condition doesn't hold
+static void
+check(bool _condition, std::string_view _what)
+{
+    if (!_condition)
+        throw test_failure(std::string(_what));
+}
+
+// contains is whether the rendered text has the line
+static bool
+contains(const std::string& _text, std::string_view _line)
+{
+    return _text.find(_line) != std::string::npos;
+}
+
+// handle_of is the typed handle of an object
+template<typename underlying_type>
+handle<underlying_type>
+handle_of(const base_object& _object)
+{
+    return *std::static_pointer_cast<handle<underlying_type>>(_object.get_handle());
+}
+
+// links to a deleted node still render with the handle the node had, as long as they reference it
+static void
+test_delete_referenced_node()
+{
+    graph<int> _graph;
+    node& source = _graph.new_object<node>();
+    source.set<OP_name>("Source");
+    node& target = _graph.new_object<node>();
+    target.set<OP_name>("Target");
+    _graph.new_link(source, target, "uses");
+    const std::string expected =
+      std::format("{} --\"uses\"--> {}", source.get_handle()->print(), target.get_handle()->print());
+
+    _graph.delete_object(handle_of<int>(target));
+    const std::string rendered = _graph.to_string();
+    check(contains(rendered, expected), "link to deleted node renders its handle");
+    check(!contains(rendered, "label: Target"), "deleted node is not rendered");
+
+    // handles nothing references are dropped by later deletes, the referenced one stays printable
+    for (int i = 0; i < 1000; ++i)
+        _graph.delete_object(handle_of<int>(_graph.new_object<node>()));
+    check(contains(_graph.to_string(), expected), "link to deleted node renders after unreferenced ones are dropped");
+}
+
+// a slot id invalidated by a delete can't be allocated again, even once its slot is reused
+static void
+test_stale_slot_id()
+{
+    graph<slot_id> _graph;
+    const handle<slot_id> stale = handle_of<slot_id>(_graph.new_object<node>());
+    _graph.delete_object(stale);
+    const handle<slot_id> reused = handle_of<slot_id>(_graph.new_object<node>());
+    check(reused.id().Index == stale.id().Index && reused.id().Generation > stale.id().Generation,
+          "deleted slot is reused under a new generation");
+
+    _graph.delete_object(reused);
+    bool rejected = false;
+    try {
+        _graph.new_object_at<node>(stale);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    check(rejected, "stale generation is rejected");
+
+    const slot_id current{ stale.id().Index, reused.id().Generation + 1 };
+    _graph.new_object_at<node>(handle<slot_id>(current));
+    check(handle_of<slot_id>(_graph.new_object<node>()).id().Index != current.Index, "taken slot leaves the free list");
+}
+
+// renders on one worker_pool from several threads take turns and match the serial render
+static void
+test_shared_worker_pool()
+{
+    graph<int> _graph;
+    std::vector<handle_ref> nodes = _graph.new_nodes(std::views::iota(0, 5000), [](int _i) {
+        return std::to_string(_i);
+    });
+    for (std::size_t i = 1; i < nodes.size(); ++i)
+        _graph.new_link(nodes[i - 1], nodes[i]);
+    const std::string serial = _graph.to_string();
+
+    worker_pool pool(4);
+    std::vector<std::string> rendered(4);
+    std::vector<std::thread> threads;
+    for (std::string& text : rendered)
+        threads.emplace_back([&_graph, &pool, &text] { text = _graph.to_string(pool); });
+    for (std::thread& thread : threads)
+        thread.join();
+    for (const std::string& text : rendered)
+        check(text == serial, "parallel render matches the serial render");
+}
+
+// incremental renders from several threads share the fragment caches, unbinding a handle only re-renders the
+// fragments that printed it
+static void
+test_concurrent_incremental_render()
+{
+    graph<int> _graph;
+    std::vector<handle_ref> nodes = _graph.new_nodes(std::views::iota(0, 200), [](int _i) {
+        return std::to_string(_i);
+    });
+    for (std::size_t i = 1; i < nodes.size(); ++i)
+        _graph.new_link(nodes[i - 1], nodes[i]);
+    node& extra = _graph.new_object<node>();
+    extra.set<OP_name>("extra");
+    const std::string before = _graph.to_string();
+    _graph.set<GP_incremental_render>(true);
+
+    std::vector<std::string> rendered(4);
+    std::vector<std::thread> threads;
+    for (std::string& text : rendered)
+        threads.emplace_back([&_graph, &text] { text = _graph.to_string(); });
+    for (std::thread& thread : threads)
+        thread.join();
+    for (const std::string& text : rendered)
+        check(text == before, "concurrent incremental renders match");
+
+    _graph.delete_object(handle_of<int>(extra));
+    const std::string after = _graph.to_string();
+    _graph.set<GP_incremental_render>(false);
+    check(after == _graph.to_string(), "incremental render matches the full render after a delete");
+}
+
+// every pair of a token_bucket_sampler has its own limit, a busy pair doesn't take the budget of others
+static void
+test_token_bucket_pairs()
+{
+    token_bucket_sampler<int> sampler(0.001, 1, 4096);
+    for (int i = 0; i < 2000; ++i)
+        check(sampler.sample(i, i + 1), "first event of a pair is kept");
+    for (int i = 0; i < 2000; ++i)
+        check(!sampler.sample(i, i + 1), "second event of a pair is over its limit");
+}
+
+// a graph loaded from a snapshot keeps counting identical links into the aggregated one
+static void
+test_snapshot_aggregated_links()
+{
+    graph<int> _graph;
+    _graph.set<GP_aggregate_links>(true);
+    node& caller = _graph.new_object<node>();
+    caller.set<OP_name>("Client");
+    node& callee = _graph.new_object<node>();
+    callee.set<OP_name>("Server");
+    for (int i = 0; i < 5; ++i)
+        _graph.new_link(caller, callee, "call");
+
+    std::string bytes;
+    _graph.save_snapshot(bytes);
+    graph<int> loaded = graph<int>::load_snapshot(snapshot_view(bytes));
+    loaded.new_link(loaded.access<node>(handle_of<int>(caller)), loaded.access<node>(handle_of<int>(callee)), "call");
+
+    const std::string rendered = loaded.to_string();
+    check(contains(rendered, "call (x6)"), "new link counts into the restored one");
+    check(rendered.find("call") == rendered.rfind("call"), "identical link is rendered once");
+}
+
+// links to a deleted node keep rendering its handle in a graph loaded from a snapshot
+static void
+test_snapshot_deleted_target()
+{
+    graph<std::string> _graph;
+    node& caller = _graph.new_object_at<node>(handle<std::string>("client"));
+    caller.set<OP_name>("Client");
+    node& callee = _graph.new_object_at<node>(handle<std::string>("server"));
+    callee.set<OP_name>("Server");
+    _graph.new_link(caller, callee, "call");
+    _graph.delete_object(handle<std::string>("server"));
+    const std::string expected = _graph.to_string();
+
+    std::string bytes;
+    _graph.save_snapshot(bytes);
+    snapshot_view view(bytes);
+    check(view.object_count() == 2 && view.retired_count() == 1, "deleted target is saved as a retired handle");
+    check(view.retired(0).handle_id<std::string>() == "server", "retired handle keeps its id");
+    check(graph<std::string>::load_snapshot(view).to_string() == expected, "loaded graph renders the same");
+}
+
+// a graph merged by move allocates from new pools of its own, not from the ones the merge target took
+static void
+test_reuse_moved_from_graph()
+{
+    graph<int> source;
+    source.new_object<node>().set<OP_name>("moved");
+    {
+        graph<int> target;
+        target.merge(std::move(source));
+        check(contains(target.to_string(), "label: moved"), "merge moves the objects");
+    }
+
+    node& reused = source.new_object<node>();
+    reused.set<OP_name>("reused");
+    check(contains(source.to_string(), "label: reused"), "moved-from graph renders its new objects");
+}
+
+// copies of objects keep their strings once the graph they were copied from is gone, string properties still read
+// as std::string
+static void
+test_copy_outlives_graph()
+{
+    std::optional<node> copy;
+    {
+        graph<int> _graph;
+        node& original = _graph.new_object<node>();
+        original.set<OP_name>("kept").set<NP_class_def>("Start");
+        copy.emplace(original);
+    }
+
+    const node& copied = *copy;
+    const std::string& name = copied.get<OP_name>().Value;
+    check(name == "kept", "name of the copy is readable as std::string");
+    check(std::string_view(copied.get<NP_class_def>().Value.c_str()) == "Start", "class of the copy is kept");
+}
+
+// handles shared out of a graph may be released on other threads while the graph creates objects
+static void
+test_release_handles_remotely()
+{
+    graph<int> _graph;
+    std::vector<std::shared_ptr<const base_handle>> escaped;
+    for (int i = 0; i < 20000; ++i) {
+        note& created = _graph.new_object<note>();
+        escaped.push_back(created.get_handle());
+        _graph.delete_object(handle_of<int>(created));
+    }
+
+    std::thread releaser([&escaped] {
+        for (std::shared_ptr<const base_handle>& handle : escaped)
+            handle.reset();
+    });
+    for (int i = 0; i < 20000; ++i)
+        _graph.new_object<node>().set<OP_name>(std::to_string(i));
+    releaser.join();
+    check(contains(_graph.to_string(), "label: 19999"), "objects created while handles are released render");
+}
+
+// links to a deleted node keep rendering its handle in the graph they are merged into, copied or moved
+static void
+test_merge_deleted_target()
+{
+    graph<int> source;
+    node& caller = source.new_object<node>();
+    caller.set<OP_name>("Client");
+    node& callee = source.new_object<node>();
+    callee.set<OP_name>("Server");
+    source.new_link(caller, callee, "call");
+    const std::string expected =
+      std::format("{} --\"call\"--> {}", caller.get_handle()->print(), callee.get_handle()->print());
+    source.delete_object(handle_of<int>(callee));
+
+    graph<int> copied;
+    copied.merge(source);
+    check(contains(copied.to_string(), expected), "copied link renders the deleted target");
+
+    graph<int> moved;
+    moved.merge(std::move(source));
+    check(contains(moved.to_string(), expected), "moved link renders the deleted target");
+}
+
+// recorded messages are replayed like new_link, identical ones are aggregated when the graph asks for it
+static void
+test_recorder_aggregates_links()
+{
+    graph<int> _graph;
+    _graph.set<GP_type>(graph_type::k_sequence).set<GP_aggregate_links>(true);
+    recorder<int> events(_graph);
+    events.participant(1, "Client");
+    events.participant(2, "Server");
+    for (int i = 0; i < 3; ++i)
+        events.message(1, 2, "call");
+
+    const std::string rendered = events.to_string();
+    check(contains(rendered, "call (x3)"), "recorded messages are counted");
+    check(rendered.find("call") == rendered.rfind("call"), "identical message is rendered once");
+}
+
+// messages recorded by several threads are all flushed, in the order each thread recorded them, text longer than
+// a buffer chunk included
+static void
+test_recorder_threads()
+{
+    constexpr int k_threads = 4;
+    constexpr int k_messages = 2000;
+    graph<int> _graph;
+    _graph.set<GP_type>(graph_type::k_sequence);
+    recorder<int> events(_graph);
+    for (int t = 0; t < k_threads; ++t) {
+        events.participant(t, std::format("Client{}", t));
+        events.participant(k_threads + t, std::format("Server{}", t));
+    }
+
+    const std::string long_text(20000, 'x');
+    std::vector<std::thread> threads;
+    for (int t = 0; t < k_threads; ++t) {
+        threads.emplace_back([&events, &long_text, t] {
+            for (int i = 0; i < k_messages; ++i)
+                events.message(t, k_threads + t, std::format("m{}.{}", t, i));
+            events.message(t, k_threads + t, long_text);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    const std::string rendered = events.to_string();
+    std::vector<int> next(k_threads, 0);
+    for (std::string_view line : rendered | std::views::split('\n') | std::views::transform([](auto&& _line) {
+                                     return std::string_view(_line.begin(), _line.end());
+                                 })) {
+        const std::size_t text = line.find(" : m");
+        if (text == std::string_view::npos)
+            continue;
+        const std::string_view id = line.substr(text + 4);
+        const int t = id[0] - '0';
+        check(id == std::format("{}.{}", t, next[t]), "messages of a thread keep their order");
+        ++next[t];
+    }
+    for (int t = 0; t < k_threads; ++t)
+        check(next[t] == k_messages, "every message of a thread is flushed");
+    check(contains(rendered, std::format(" : {}\n", long_text)), "long message is flushed whole");
+}
+
+// bounded graphs drop participants no message referenced once the window moved past them
+static void
+test_evict_unused_participant()
+{
+    graph<int> _graph;
+    _graph.set<GP_type>(graph_type::k_sequence).set<GP_message_capacity>(2);
+    _graph.new_object<node>().set<OP_name>("Unused");
+    node& caller = _graph.new_object<node>();
+    caller.set<OP_name>("Client");
+    node& callee = _graph.new_object<node>();
+    callee.set<OP_name>("Server");
+    for (int i = 0; i < 3; ++i)
+        _graph.new_link(caller, callee, std::format("call{}", i));
+
+    const std::string rendered = _graph.to_string();
+    check(!contains(rendered, "Unused"), "unused participant is evicted");
+    check(contains(rendered, "Client") && contains(rendered, "Server"), "used participants are kept");
+    check(!contains(rendered, "call0") && contains(rendered, "call2"), "oldest message is evicted");
+
+    node& late = _graph.new_object<node>();
+    late.set<OP_name>("Late");
+    _graph.new_link(caller, callee, "call3");
+    _graph.new_link(late, callee, "call4");
+    check(contains(_graph.to_string(), "Late"), "participant created in the window is kept until referenced");
+}
+
+// static_flowchart is a flowchart built by static_graph, with class definitions, subgraphs and counted links
+static constexpr static_graph
+static_flowchart()
+{
+    static_graph g;
+    g.set<OP_name>("Pipeline");
+    g.set<GP_flowchart_direction>(GP_flowchart_direction<int>::k_left_to_right);
+    auto hot = g.new_object<class_def>();
+    hot.set<OP_name>("Hot").set<MCD_fill>("#f96").set<MCD_stroke>("#333").set<MCD_color>("#fff");
+    auto parser = g.new_object<node>();
+    parser.set<OP_name>("Parser").set<NP_class_def>("Hot");
+    auto checker = g.new_object<node>();
+    checker.set<OP_name>("Checker").set<NP_shape>(NP_shape::k_diamond);
+    auto writer = g.new_object<node>();
+    writer.set<OP_name>("Writer").set<NP_shape>(NP_shape::k_parallelogram);
+    auto stage = g.new_object<node>();
+    stage.set<OP_name>("Front end").set<NP_subgraph_node>({ parser, checker });
+    g.new_link(parser, checker, "tokens");
+    g.new_link(checker, writer, {}, LP_style::k_dashed | LP_style::k_arrow_mask);
+    g.new_link(checker, parser).set<LP_count>(3);
+    g.new_link(writer, parser, "retry").set<LP_count>(2);
+    g.new_link(parser, writer, {}, LP_style::k_bold_solid);
+    return g;
+}
+
+// static_sequence is a sequence diagram built by static_graph, with notes, activations and counted messages
+static constexpr static_graph
+static_sequence()
+{
+    static_graph g(graph_type::k_sequence);
+    g.set<GP_sequence_show_number>(true).set<GP_output_format>(graph_output_format::k_mermaid);
+    auto client = g.new_object<node>();
+    client.set<OP_name>("Client");
+    auto server = g.new_object<node>();
+    server.set<OP_name>("Server");
+    g.new_link(client, server, "request").set<LP_activate>(true);
+    g.new_link(server, client, "response", LP_style::k_dashed | LP_style::k_arrow_mask).set<LP_activate>(false);
+    g.new_link(client, server, "ping").set<LP_count>(4);
+    g.new_object<note>().set<OP_name>("waits").set<MNP_basis>({ client }).set<MNP_orient>(MNP_orient::k_right);
+    g.new_object<note>().set<OP_name>("session").set<MNP_basis>({ client, server });
+    return g;
+}
+
+// a static_graph renders the same text as a graph<int> built in the same order, at compile time too
+static void
+test_static_graph_matches_graph()
+{
+    graph<int> flowchart;
+    flowchart.set<OP_name>("Pipeline");
+    flowchart.set<GP_flowchart_direction>(GP_flowchart_direction<int>::k_left_to_right);
+    flowchart.new_object<class_def>()
+      .set<OP_name>("Hot")
+      .set<MCD_fill>("#f96")
+      .set<MCD_stroke>("#333")
+      .set<MCD_color>("#fff");
+    node& parser = flowchart.new_object<node>();
+    parser.set<OP_name>("Parser").set<NP_class_def>("Hot");
+    node& checker = flowchart.new_object<node>();
+    checker.set<OP_name>("Checker").set<NP_shape>(NP_shape::k_diamond);
+    node& writer = flowchart.new_object<node>();
+    writer.set<OP_name>("Writer").set<NP_shape>(NP_shape::k_parallelogram);
+    flowchart.new_object<node>()
+      .set<OP_name>("Front end")
+      .set<NP_subgraph_node>(std::vector<handle_ref>{ parser.get_handle_ref(), checker.get_handle_ref() });
+    flowchart.new_link(parser, checker, "tokens");
+    flowchart.new_link(checker, writer, {}, LP_style::k_dashed | LP_style::k_arrow_mask);
+    flowchart.new_link(checker, parser).set<LP_count>(3);
+    flowchart.new_link(writer, parser, "retry").set<LP_count>(2);
+    flowchart.new_link(parser, writer, {}, LP_style::k_bold_solid);
+
+    const std::string expected_flowchart = flowchart.to_string();
+    check(static_flowchart().to_string() == expected_flowchart, "static flowchart matches the graph");
+    constexpr auto k_flowchart = static_mermaid<static_flowchart>;
+    check(k_flowchart.view() == expected_flowchart, "compile-time flowchart matches the graph");
+
+    graph<int> sequence;
+    sequence.set<GP_type>(graph_type::k_sequence)
+      .set<GP_sequence_show_number>(true)
+      .set<GP_output_format>(graph_output_format::k_mermaid);
+    node& client = sequence.new_object<node>();
+    client.set<OP_name>("Client");
+    node& server = sequence.new_object<node>();
+    server.set<OP_name>("Server");
+    sequence.new_link(client, server, "request").set<LP_activate>(true);
+    sequence.new_link(server, client, "response", LP_style::k_dashed | LP_style::k_arrow_mask)
+      .set<LP_activate>(false);
+    sequence.new_link(client, server, "ping").set<LP_count>(4);
+    sequence.new_object<note>()
+      .set<OP_name>("waits")
+      .set<MNP_basis>(std::vector<handle_ref>{ client.get_handle_ref() })
+      .set<MNP_orient>(MNP_orient::k_right);
+    sequence.new_object<note>()
+      .set<OP_name>("session")
+      .set<MNP_basis>(std::vector<handle_ref>{ client.get_handle_ref(), server.get_handle_ref() });
+
+    const std::string expected_sequence = sequence.to_string();
+    check(static_sequence().to_string() == expected_sequence, "static sequence diagram matches the graph");
+    constexpr auto k_sequence = static_mermaid<static_sequence>;
+    check(k_sequence.view() == expected_sequence, "compile-time sequence diagram matches the graph");
+}
+
+// check_round_trip is to check the graph renders the same once parsed back from its text
+template<typename underlying_type>
+static void
+check_round_trip(const graph<underlying_type>& _graph, std::string_view _what)
+{
+    const std::string rendered = _graph.to_string();
+    check(parse_mermaid<underlying_type>(rendered).to_string() == rendered, _what);
+}
+
+// round_trip_flowchart is to round trip a flowchart with class definitions, shapes, a subgraph, counted links and a
+// link to a deleted node, nodes are created by _new_node
+template<typename underlying_type, typename new_node_type>
+static void
+round_trip_flowchart(const new_node_type& _new_node)
+{
+    graph<underlying_type> _graph;
+    _graph.template set<OP_name>("Pipeline");
+    _graph.template set<GP_flowchart_direction>(GP_flowchart_direction<underlying_type>::k_left_to_right)
+      .template set<GP_aggregate_links>(true);
+    class_def& hot = _graph.template new_object<class_def>();
+    hot.set<OP_name>("Hot").set<MCD_fill>("#f96").set<MCD_color>("#fff");
+    node& parser = _new_node(_graph);
+    parser.set<OP_name>("Parser").set<NP_class_def>("Hot");
+    node& checker = _new_node(_graph);
+    checker.set<OP_name>("Checker").set<NP_shape>(NP_shape::k_diamond);
+    node& writer = _new_node(_graph);
+    writer.set<OP_name>("Writer").set<NP_shape>(NP_shape::k_parallelogram);
+    node& removed = _new_node(_graph);
+    removed.set<OP_name>("Removed");
+    node& stage = _new_node(_graph);
+    stage.set<OP_name>("Front end")
+      .set<NP_subgraph_node>(std::vector<handle_ref>{ parser.get_handle_ref(), checker.get_handle_ref() });
+    for (int i = 0; i < 3; ++i)
+        _graph.new_link(parser, checker, "tokens");
+    _graph.new_link(checker, writer, {}, LP_style::k_dashed | LP_style::k_arrow_mask);
+    _graph.new_link(writer, removed, "flush");
+    _graph.delete_object(handle_of<underlying_type>(removed));
+    node& late = _new_node(_graph);
+    late.set<OP_name>("Late");
+    check_round_trip(_graph, "flowchart round trips");
+}
+
+// round_trip_sequence is to round trip a sequence diagram with activations, notes and a message to a deleted
+// participant, participants are created by _new_node
+template<typename underlying_type, typename new_node_type>
+static void
+round_trip_sequence(const new_node_type& _new_node)
+{
+    graph<underlying_type> _graph;
+    _graph.template set<GP_type>(graph_type::k_sequence).template set<GP_sequence_show_number>(true);
+    node& client = _new_node(_graph);
+    client.set<OP_name>("Client");
+    node& server = _new_node(_graph);
+    server.set<OP_name>("Server");
+    node& cache = _new_node(_graph);
+    cache.set<OP_name>("Cache");
+    _graph.new_link(client, server, "request").template set<LP_activate>(true);
+    _graph.new_link(server, cache, "lookup");
+    _graph.new_link(server, client, "response", LP_style::k_dashed | LP_style::k_arrow_mask)
+      .template set<LP_activate>(false);
+    note& waits = _graph.template new_object<note>();
+    waits.set<OP_name>("waits")
+      .set<MNP_basis>(std::vector<handle_ref>{ client.get_handle_ref() })
+      .set<MNP_orient>(MNP_orient::k_right);
+    note& session = _graph.template new_object<note>();
+    session.set<OP_name>("session").set<MNP_basis>(
+      std::vector<handle_ref>{ client.get_handle_ref(), server.get_handle_ref() });
+    _graph.delete_object(handle_of<underlying_type>(cache));
+    node& replica = _new_node(_graph);
+    replica.set<OP_name>("Replica");
+    check_round_trip(_graph, "sequence diagram round trips");
+}
+
+// rendered flowcharts and sequence diagrams parse back to graphs rendering the same, for every handle type the
+// parser reads, links to deleted nodes included
+static void
+test_mermaid_round_trip()
+{
+    auto new_node = []<typename underlying_type>(graph<underlying_type>& _graph) -> node& {
+        return _graph.template new_object<node>();
+    };
+    round_trip_flowchart<int>(new_node);
+    round_trip_sequence<int>(new_node);
+    round_trip_flowchart<slot_id>(new_node);
+    round_trip_sequence<slot_id>(new_node);
+
+    static const std::array<int, 8> objects{};
+    std::size_t next = 0;
+    auto new_hooked_node = [&next](graph<const void*>& _graph) -> node& {
+        return _graph.new_object_at<node>(handle<const void*>(&objects[next++ % objects.size()]));
+    };
+    round_trip_flowchart<const void*>(new_hooked_node);
+    next = 0;
+    round_trip_sequence<const void*>(new_hooked_node);
+}
+
+// objects that don't belong to a graph keep their strings in a pool of their own, copies keep theirs once the
+// original is gone
+static void
+test_standalone_object_strings()
+{
+    std::optional<node> original(std::in_place);
+    original->set<OP_name>("alone").set<NP_class_def>("Start");
+    node copy(*original);
+    original.reset();
+    check(copy.get<OP_name>().Value == "alone", "copy of a standalone object keeps its name");
+    check(copy.get<NP_class_def>().Value.str() == "Start", "copy of a standalone object keeps its class");
+
+    copy.set<OP_name>("renamed");
+    check(copy.get<OP_name>().Value == "renamed", "standalone copy interns new strings");
+}
+
+// test_case is a named regression test
+struct test_case
+{
+    std::string_view Name;
+    std::function<void()> Run;
+};
+
+int
+main(int _argc, char** _argv)
+{
+    const std::vector<test_case> cases = {
+        { "delete_referenced_node", test_delete_referenced_node },
+        { "stale_slot_id", test_stale_slot_id },
+        { "shared_worker_pool", test_shared_worker_pool },
+        { "concurrent_incremental_render", test_concurrent_incremental_render },
+        { "token_bucket_pairs", test_token_bucket_pairs },
+        { "snapshot_aggregated_links", test_snapshot_aggregated_links },
+        { "snapshot_deleted_target", test_snapshot_deleted_target },
+        { "reuse_moved_from_graph", test_reuse_moved_from_graph },
+        { "copy_outlives_graph", test_copy_outlives_graph },
+        { "release_handles_remotely", test_release_handles_remotely },
+        { "merge_deleted_target", test_merge_deleted_target },
+        { "recorder_aggregates_links", test_recorder_aggregates_links },
+        { "recorder_threads", test_recorder_threads },
+        { "evict_unused_participant", test_evict_unused_participant },
+        { "static_graph_matches_graph", test_static_graph_matches_graph },
+        { "mermaid_round_trip", test_mermaid_round_trip },
+        { "standalone_object_strings", test_standalone_object_strings },
+    };
+
+    int failed = 0;
+    for (const test_case& test : cases) {
+        if (_argc > 1 && test.Name != _argv[1])
+            continue;
+        try {
+            test.Run();
+            std::cout << "[ OK ] " << test.Name << "\n";
+        } catch (const std::exception& _error) {
+            std::cout << "[FAIL] " << test.Name << ": " << _error.what() << "\n";
+            ++failed;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}